@@ -0,0 +1,450 @@
+#include "bench.h"
+#include "pattern.h"
+#include "playout.h"
+#include "search.h"
+
+#include <cstdlib>
+#include <iomanip>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+struct BenchPosition {
+	Board board;
+	int side;
+};
+
+struct BenchSettings {
+	int size = 8;
+	int count = 12;
+	SearchLimits limits;
+	SearchOptions options;
+};
+
+// The same openings on every run and platform: random legal moves from a fixed seed.
+static std::vector<BenchPosition> BenchPositions(const BenchSettings& settings) {
+	std::mt19937 random(20211017);
+	std::vector<BenchPosition> positions;
+	int squares = settings.size * settings.size;
+	while ((int)positions.size() < settings.count) {
+		BenchPosition position{ StartingBoard(settings.size), 0 };
+		int plies = 2 + (int)(random() % (squares / 3));
+		for (int i = 0; i < plies; i++) {
+			uint64_t moves = LegalMoves(position.board, settings.size);
+			if (!moves) break;
+			for (int skip = (int)(random() % PopCount(moves)); skip > 0; skip--) moves &= moves - 1;
+			position.board = Play(position.board, moves & (0 - moves), settings.size);
+			position.side ^= 1;
+		}
+		if (LegalMoves(position.board, settings.size)) positions.push_back(position);
+	}
+	return positions;
+}
+
+// Positions with exactly empties empty squares, from random games on the same fixed seed.
+static std::vector<BenchPosition> EndgamePositions(const BenchSettings& settings, int empties) {
+	std::mt19937 random(20211017);
+	std::vector<BenchPosition> positions;
+	while ((int)positions.size() < settings.count) {
+		BenchPosition position{ StartingBoard(settings.size), 0 };
+		int left = settings.size * settings.size - 4;
+		while (left > empties) {
+			uint64_t moves = LegalMoves(position.board, settings.size);
+			if (!moves) {
+				position.board = Pass(position.board);
+				position.side ^= 1;
+				if (!LegalMoves(position.board, settings.size)) break;
+				continue;
+			}
+			for (int skip = (int)(random() % PopCount(moves)); skip > 0; skip--) moves &= moves - 1;
+			position.board = Play(position.board, moves & (0 - moves), settings.size);
+			position.side ^= 1;
+			left--;
+		}
+		if (left == empties && LegalMoves(position.board, settings.size)) positions.push_back(position);
+	}
+	return positions;
+}
+
+static SearchResult BenchSearch(const BenchSettings& settings, const BenchPosition& position, const SearchOptions& options) {
+	TransTable.clear(); // Every search starts from the same empty table.
+	return MiniMaxDecision(position.board, settings.size, position.side, settings.limits, options);
+}
+
+// Node counts of plain alpha-beta against PVS to the same depth on the fixed positions.
+static int BenchAlgorithms(const BenchSettings& settings) {
+	SearchOptions alphaBeta = settings.options, pvs = settings.options;
+	alphaBeta.algorithm = SearchAlgorithm::ALPHA_BETA;
+	pvs.algorithm = SearchAlgorithm::PVS;
+	uint64_t totalAlphaBeta = 0, totalPVS = 0;
+	std::cout << "position  depth   alphabeta nodes   pvs nodes   ratio\n";
+	std::vector<BenchPosition> positions = BenchPositions(settings);
+	for (size_t i = 0; i < positions.size(); i++) {
+		SearchResult a = BenchSearch(settings, positions[i], alphaBeta);
+		SearchResult p = BenchSearch(settings, positions[i], pvs);
+		totalAlphaBeta += a.nodes;
+		totalPVS += p.nodes;
+		std::cout << std::setw(8) << i << std::setw(7) << p.depth << std::setw(18) << a.nodes << std::setw(12) << p.nodes
+			<< std::setw(8) << std::fixed << std::setprecision(3) << (double)p.nodes / a.nodes;
+		if (a.score != p.score) std::cout << "  score mismatch: " << a.score << " vs " << p.score;
+		std::cout << "\n";
+	}
+	std::cout << "   total" << std::setw(25) << totalAlphaBeta << std::setw(12) << totalPVS
+		<< std::setw(8) << (double)totalPVS / totalAlphaBeta << std::endl;
+	return 0;
+}
+
+// Total nodes and the share of cutoffs found on the first move for each ordering configuration.
+static int BenchOrdering(const BenchSettings& settings) {
+	struct Configuration {
+		const char* name;
+		uint32_t flags;
+	};
+	const Configuration configurations[] = {
+		{ "none", 0 },
+		{ "tt", ORDER_TT },
+		{ "tt,killers", ORDER_TT | ORDER_KILLERS },
+		{ "tt,history", ORDER_TT | ORDER_HISTORY },
+		{ "tt,killers,history", ORDER_TT | ORDER_KILLERS | ORDER_HISTORY },
+		{ "tt,killers,history,squares", ORDER_TT | ORDER_KILLERS | ORDER_HISTORY | ORDER_SQUARES },
+		{ "squares", ORDER_SQUARES }
+	};
+	std::vector<BenchPosition> positions = BenchPositions(settings);
+	std::cout << "ordering                          nodes   first move cutoffs   seconds\n";
+	for (const Configuration& configuration : configurations) {
+		SearchOptions options = settings.options;
+		options.ordering = configuration.flags;
+		uint64_t nodes = 0, cutoffs = 0, firstMoveCutoffs = 0;
+		double seconds = 0;
+		for (const BenchPosition& position : positions) {
+			SearchResult result = BenchSearch(settings, position, options);
+			nodes += result.nodes;
+			cutoffs += result.cutoffs;
+			firstMoveCutoffs += result.firstMoveCutoffs;
+			seconds += result.seconds;
+		}
+		std::cout << std::left << std::setw(28) << configuration.name << std::right << std::setw(13) << nodes
+			<< std::setw(20) << std::fixed << std::setprecision(1) << (cutoffs ? 100.0 * firstMoveCutoffs / cutoffs : 0.0) << "%"
+			<< std::setw(10) << std::setprecision(3) << seconds << "\n";
+	}
+	std::cout << std::flush;
+	return 0;
+}
+
+// Time to the same depth with 1, 2, 4... threads up to maxThreads, checking every answer against one thread.
+// With empties the threads solve the endgame positions of BenchEndgame instead.
+static int BenchThreads(const BenchSettings& settings, int maxThreads, int empties) {
+	BenchSettings search = settings;
+	if (empties > 0) {
+		search.limits.depth = 0;
+		search.options.solveEmpties = empties;
+	}
+	std::vector<BenchPosition> positions = empties > 0 ? EndgamePositions(settings, empties) : BenchPositions(settings);
+	std::vector<SearchResult> single;
+	double singleSeconds = 0;
+	std::cout << "threads         nodes   seconds   speedup   mismatches\n";
+	for (int threads = 1; threads <= maxThreads; threads = threads * 2 > maxThreads && threads < maxThreads ? maxThreads : threads * 2) {
+		SearchOptions options = search.options;
+		options.threads = threads;
+		uint64_t nodes = 0;
+		double seconds = 0;
+		int mismatches = 0;
+		for (size_t i = 0; i < positions.size(); i++) {
+			SearchResult result = BenchSearch(search, positions[i], options);
+			nodes += result.nodes;
+			seconds += result.seconds;
+			if (threads == 1) single.push_back(result);
+			else if (result.move != single[i].move || result.score != single[i].score) mismatches++;
+		}
+		if (threads == 1) singleSeconds = seconds;
+		std::cout << std::setw(7) << threads << std::setw(14) << nodes << std::setw(10) << std::fixed << std::setprecision(3) << seconds
+			<< std::setw(10) << std::setprecision(2) << singleSeconds / seconds << std::setw(13) << mismatches << "\n";
+	}
+	std::cout << std::flush;
+	return 0;
+}
+
+// Nodes of the full window, aspiration window and MTD(f) drivers, checking both against the full window.
+static int BenchDrivers(const BenchSettings& settings) {
+	struct Driver {
+		const char* name;
+		SearchDriver driver;
+	};
+	const Driver drivers[] = { { "full", SearchDriver::FULL_WINDOW }, { "aspiration", SearchDriver::ASPIRATION }, { "mtdf", SearchDriver::MTDF } };
+	std::vector<BenchPosition> positions = BenchPositions(settings);
+	std::vector<SearchResult> full;
+	uint64_t fullNodes = 0;
+	std::cout << "driver              nodes   seconds   ratio   mismatches\n";
+	for (const Driver& driver : drivers) {
+		SearchOptions options = settings.options;
+		options.driver = driver.driver;
+		uint64_t nodes = 0;
+		double seconds = 0;
+		int mismatches = 0;
+		for (size_t i = 0; i < positions.size(); i++) {
+			SearchResult result = BenchSearch(settings, positions[i], options);
+			nodes += result.nodes;
+			seconds += result.seconds;
+			if (driver.driver == SearchDriver::FULL_WINDOW) full.push_back(result);
+			else if (result.move != full[i].move || result.score != full[i].score) mismatches++;
+		}
+		if (driver.driver == SearchDriver::FULL_WINDOW) fullNodes = nodes;
+		std::cout << std::left << std::setw(12) << driver.name << std::right << std::setw(13) << nodes << std::setw(10) << std::fixed << std::setprecision(3) << seconds
+			<< std::setw(8) << (double)nodes / fullNodes << std::setw(13) << mismatches << "\n";
+	}
+	std::cout << std::flush;
+	return 0;
+}
+
+// Solves positions with the given number of empties outright and prints the time each took.
+static int BenchEndgame(const BenchSettings& settings, int empties) {
+	BenchSettings solve = settings;
+	solve.limits.depth = 0;
+	solve.options.solveEmpties = empties;
+	uint64_t nodes = 0;
+	double seconds = 0;
+	std::cout << "position   score          nodes   seconds   nodes/s\n";
+	std::vector<BenchPosition> positions = EndgamePositions(settings, empties);
+	for (size_t i = 0; i < positions.size(); i++) {
+		SearchResult result = BenchSearch(solve, positions[i], solve.options);
+		nodes += result.nodes;
+		seconds += result.seconds;
+		std::cout << std::setw(8) << i << std::setw(8) << result.score << (result.exact ? " " : "?") << std::setw(14) << result.nodes
+			<< std::setw(10) << std::fixed << std::setprecision(3) << result.seconds << std::setw(10) << std::setprecision(0) << result.nodes / result.seconds << std::endl;
+	}
+	std::cout << "   total" << std::setw(23) << nodes << std::setw(10) << std::setprecision(3) << seconds << std::setw(10) << std::setprecision(0) << nodes / seconds << std::endl;
+	return 0;
+}
+
+// Nodes and time to the same depth over the decisions of a game, with the table kept from one
+// decision to the next and cleared before each. Fresh searches play lines of plies moves from the
+// bench positions, and both search the positions of one side along them: the other side's moves
+// come from outside, like a human opponent's. The first decision of a line, which has nothing to
+// reuse, is not counted.
+static int BenchReuse(const BenchSettings& settings, int plies) {
+	std::vector<std::vector<BenchPosition>> lines;
+	uint64_t freshNodes = 0, keptNodes = 0;
+	double freshSeconds = 0, keptSeconds = 0;
+	for (const BenchPosition& start : BenchPositions(settings)) {
+		std::vector<BenchPosition> line;
+		BenchPosition position = start;
+		for (int ply = 0; ply < plies && LegalMoves(position.board, settings.size); ply++) {
+			SearchResult result = BenchSearch(settings, position, settings.options);
+			if (ply % 2 == 0) {
+				line.push_back(position);
+				if (ply > 0) {
+					freshNodes += result.nodes;
+					freshSeconds += result.seconds;
+				}
+			}
+			position.board = Play(position.board, result.move, settings.size);
+			position.side ^= 1;
+			if (!LegalMoves(position.board, settings.size)) {
+				position.board = Pass(position.board);
+				position.side ^= 1;
+			}
+		}
+		lines.push_back(line);
+	}
+	for (const std::vector<BenchPosition>& line : lines) {
+		TransTable.clear();
+		for (size_t i = 0; i < line.size(); i++) {
+			SearchResult result = MiniMaxDecision(line[i].board, settings.size, line[i].side, settings.limits, settings.options);
+			if (i == 0) continue;
+			keptNodes += result.nodes;
+			keptSeconds += result.seconds;
+		}
+	}
+	std::cout << "state          nodes   seconds   ratio\n" << std::fixed;
+	std::cout << "fresh" << std::setw(15) << freshNodes << std::setw(10) << std::setprecision(3) << freshSeconds << std::setw(8) << 1.0 << "\n";
+	std::cout << "kept " << std::setw(15) << keptNodes << std::setw(10) << std::setprecision(3) << keptSeconds << std::setw(8) << (double)keptNodes / freshNodes << "\n";
+	std::cout << std::flush;
+	return 0;
+}
+
+// Random games per second from the bench positions with each playout kernel the processor runs.
+// The mean outcome should agree between kernels, they play the same random games differently.
+static int BenchPlayouts(const BenchSettings& settings, int games) {
+	struct Kernel {
+		const char* name;
+		PlayoutKernel kernel;
+	};
+	const Kernel kernels[] = { { "scalar", PlayoutKernel::SCALAR }, { "avx2", PlayoutKernel::AVX2 } };
+	std::vector<BenchPosition> positions = BenchPositions(settings);
+	std::vector<int> outcomes(games);
+	double scalarSeconds = 0;
+	std::cout << "kernel          games   seconds    games/s   speedup   mean\n";
+	for (const Kernel& kernel : kernels) {
+		if (kernel.kernel == PlayoutKernel::AVX2 && BestPlayoutKernel() != PlayoutKernel::AVX2) {
+			std::cout << std::left << std::setw(10) << kernel.name << std::right << "  not supported by this processor\n";
+			continue;
+		}
+		FastRandom random(1);
+		long long total = 0;
+		auto start = std::chrono::high_resolution_clock::now();
+		for (const BenchPosition& position : positions) {
+			RandomPlayouts(position.board, settings.size, games, random, outcomes.data(), kernel.kernel);
+			for (int outcome : outcomes) total += outcome;
+		}
+		double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+		if (kernel.kernel == PlayoutKernel::SCALAR) scalarSeconds = seconds;
+		uint64_t played = (uint64_t)games * positions.size();
+		std::cout << std::left << std::setw(10) << kernel.name << std::right << std::setw(11) << played << std::setw(10) << std::fixed << std::setprecision(3) << seconds
+			<< std::setw(11) << std::setprecision(0) << played / seconds << std::setw(10) << std::setprecision(2) << scalarSeconds / seconds
+			<< std::setw(7) << (double)total / played << "\n";
+	}
+	std::cout << std::flush;
+	return 0;
+}
+
+// Plays a game from each bench position with each colour, the pattern evaluation searching to the
+// bench depth against the disc count searching to discDepth, and adds every position to seen.
+// wins, losses and discs count from the pattern side.
+static void BenchMatch(const BenchSettings& settings, int discDepth, int& wins, int& losses, int& discs, std::vector<Board>& seen) {
+	SearchOptions patterns = settings.options, count = settings.options;
+	patterns.evaluation = Evaluation::PATTERNS;
+	count.evaluation = Evaluation::DISCS;
+	BenchSettings deeper = settings;
+	deeper.limits.depth = discDepth;
+	for (const BenchPosition& start : BenchPositions(settings)) {
+		for (int patternSide = 0; patternSide < 2; patternSide++) {
+			BenchPosition position = start;
+			for (;;) {
+				if (!LegalMoves(position.board, settings.size)) {
+					position.board = Pass(position.board);
+					position.side ^= 1;
+					if (!LegalMoves(position.board, settings.size)) break;
+				}
+				seen.push_back(position.board);
+				// BenchSearch clears the table before every move, so neither side reads the other's scores.
+				SearchResult result = position.side == patternSide ? BenchSearch(settings, position, patterns) : BenchSearch(deeper, position, count);
+				position.board = Play(position.board, result.move, settings.size);
+				position.side ^= 1;
+			}
+			int difference = DiscDifference(position.board) * (position.side == patternSide ? 1 : -1);
+			discs += difference;
+			if (difference > 0) wins++;
+			else if (difference < 0) losses++;
+		}
+	}
+}
+
+// Nanoseconds per evaluation of boards, by the disc count and by the patterns.
+template<int N>
+static void TimeEvaluations(const std::vector<Board>& boards, double& discSeconds, double& patternSeconds) {
+	constexpr int REPEATS = 100;
+	volatile int sink = 0;
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int repeat = 0; repeat < REPEATS; repeat++) {
+		for (const Board& board : boards) sink += DiscDifference(board);
+	}
+	auto middle = std::chrono::high_resolution_clock::now();
+	for (int repeat = 0; repeat < REPEATS; repeat++) {
+		for (const Board& board : boards) sink += Patterns.evaluate<N>(board);
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+	double evaluations = (double)REPEATS * boards.size();
+	discSeconds = std::chrono::duration<double>(middle - start).count() * 1e9 / evaluations;
+	patternSeconds = std::chrono::duration<double>(end - middle).count() * 1e9 / evaluations;
+}
+
+// Games of the pattern evaluation against the disc count searching as deep, two plies deeper and
+// four plies deeper, then the cost of one evaluation over the positions of those games.
+static int BenchEvaluation(const BenchSettings& settings) {
+	std::vector<Board> seen;
+	std::cout << "disc count depth   wins   losses   mean discs\n";
+	for (int extra = 0; extra <= 4; extra += 2) {
+		int wins = 0, losses = 0, discs = 0;
+		BenchMatch(settings, settings.limits.depth + extra, wins, losses, discs, seen);
+		std::cout << std::setw(16) << settings.limits.depth + extra << std::setw(7) << wins << std::setw(9) << losses
+			<< std::setw(13) << std::fixed << std::setprecision(1) << (double)discs / (2 * settings.count) << std::endl;
+	}
+	double discSeconds, patternSeconds;
+	switch (settings.size) {
+		case 6: TimeEvaluations<6>(seen, discSeconds, patternSeconds); break;
+		case 8: TimeEvaluations<8>(seen, discSeconds, patternSeconds); break;
+		default: TimeEvaluations<4>(seen, discSeconds, patternSeconds); break;
+	}
+	std::cout << "evaluation   ns\n" << std::setprecision(1);
+	std::cout << "discs   " << std::setw(9) << discSeconds << "\n";
+	std::cout << "patterns" << std::setw(9) << patternSeconds << std::endl;
+	return 0;
+}
+
+int RunBenchmark(int argc, char** args) {
+	BenchSettings settings;
+	settings.limits.seconds = 0;
+	settings.limits.depth = 8;
+	int maxThreads = HardwareThreads();
+	int empties = 0;
+	int games = 100000;
+	int plies = 16;
+	std::string weights;
+	std::string benchmark = argc > 2 ? args[2] : "";
+	for (int i = 3; i < argc; i++) {
+		std::string option = args[i];
+		if (option == "--size" && i + 1 < argc) settings.size = std::atoi(args[++i]);
+		else if (option == "--depth" && i + 1 < argc) settings.limits.depth = std::atoi(args[++i]);
+		else if (option == "--positions" && i + 1 < argc) settings.count = std::atoi(args[++i]);
+		else if (option == "--hash" && i + 1 < argc) TransTable.resize(std::atoi(args[++i]));
+		else if (option == "--empties" && i + 1 < argc) empties = std::atoi(args[++i]);
+		else if (option == "--threads" && i + 1 < argc) maxThreads = std::atoi(args[++i]);
+		else if (option == "--games" && i + 1 < argc) games = std::atoi(args[++i]);
+		else if (option == "--plies" && i + 1 < argc) plies = std::atoi(args[++i]);
+		else if (option == "--weights" && i + 1 < argc) weights = args[++i];
+		else if (option == "--driver" && i + 1 < argc) {
+			if (!ParseSearchDriver(args[++i], settings.options.driver)) {
+				std::cerr << "Invalid search driver: " << args[i] << "." << std::endl;
+				return 2;
+			}
+		}
+		else if (option == "--parallel" && i + 1 < argc) {
+			if (!ParseParallelSearch(args[++i], settings.options.parallel)) {
+				std::cerr << "Invalid parallel search: " << args[i] << "." << std::endl;
+				return 2;
+			}
+		}
+		else {
+			std::cerr << "Unknown option: " << option << "." << std::endl;
+			return 2;
+		}
+	}
+	if (!IsSupportedBoardSize(settings.size)) {
+		std::cerr << "Invalid board size: " << settings.size << ".\n    Valid board sizes are: 4, 6 and 8." << std::endl;
+		return 2;
+	}
+
+	// Every benchmark but eval searches with the disc count unless given weights.
+	if (benchmark == "eval" && weights.empty()) weights = WeightsFile(settings.size);
+	if (!weights.empty() && !Patterns.load(weights, settings.size)) {
+		std::cerr << "Invalid weights: " << weights << ".\n    Train them with: " << args[0] << " train --size " << settings.size << " --out " << weights << std::endl;
+		return 2;
+	}
+
+	if (benchmark == "search") return BenchAlgorithms(settings);
+	if (benchmark == "ordering") return BenchOrdering(settings);
+	if (benchmark == "drivers") return BenchDrivers(settings);
+	if (benchmark == "endgame") {
+		int squares = settings.size * settings.size;
+		if (empties <= 0) empties = squares > 40 ? 20 : squares / 2;
+		if (empties > squares - 4) {
+			std::cerr << "Invalid number of empties: " << empties << "." << std::endl;
+			return 2;
+		}
+		return BenchEndgame(settings, empties);
+	}
+	if (benchmark == "threads") {
+		if (empties > settings.size * settings.size - 4) {
+			std::cerr << "Invalid number of empties: " << empties << "." << std::endl;
+			return 2;
+		}
+		return BenchThreads(settings, maxThreads > 0 ? maxThreads : 1, empties);
+	}
+	if (benchmark == "playouts") return BenchPlayouts(settings, games > 0 ? games : 1);
+	if (benchmark == "reuse") return BenchReuse(settings, plies > 0 ? plies : 1);
+	if (benchmark == "eval") return BenchEvaluation(settings);
+	std::cerr << "Usage: " << args[0] << " bench search|ordering|drivers|endgame|threads|playouts|reuse|eval [--size 4|6|8] [--depth <plies>] [--positions <count>] [--hash <megabytes>] [--threads <count>] [--parallel rootsplit|lazysmp|ybwc] [--driver full|aspiration|mtdf] [--empties <count>] [--games <count>] [--plies <count>] [--weights <file>]" << std::endl;
+	return 2;
+}
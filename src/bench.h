@@ -0,0 +1,4 @@
+#pragma once
+
+// Headless benchmarks, run as: othello bench <benchmark> [options]
+int RunBenchmark(int argc, char** args);
@@ -0,0 +1,173 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+
+#include <glm/glm.hpp>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Board sizes the game and search are specialized for.
+constexpr int MIN_BOARD_SIZE = 4;
+constexpr int MAX_BOARD_SIZE = 8;
+inline bool IsSupportedBoardSize(int size) {
+	return size == 4 || size == 6 || size == 8;
+}
+
+inline int PopCount(uint64_t bits) {
+#ifdef _MSC_VER
+	return (int)__popcnt64(bits);
+#else
+	return __builtin_popcountll(bits);
+#endif
+}
+
+// Index of the lowest set bit, bits must not be zero.
+inline int LowestSquare(uint64_t bits) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward64(&index, bits);
+	return (int)index;
+#else
+	return __builtin_ctzll(bits);
+#endif
+}
+
+inline bool InBoard(int size, const glm::ivec2& position) {
+	return position.x >= 0 && position.x < size && position.y >= 0 && position.y < size;
+}
+
+// Square (x, y) lives at bit x * size + y, the same order the old Piece[x][y] array used.
+inline uint64_t SquareBit(int size, const glm::ivec2& position) {
+	return 1ULL << (position.x * size + position.y);
+}
+
+template<int N>
+constexpr int SquareCount() {
+	return N * N;
+}
+
+template<int N>
+constexpr uint64_t FullMask() {
+	return ~0ULL >> (64 - N * N);
+}
+
+// Every square in the row y.
+template<int N>
+constexpr uint64_t RowMask(int y, int x = 0) {
+	return x == N ? 0 : (1ULL << (x * N + y)) | RowMask<N>(y, x + 1);
+}
+
+// Squares a step of dy along y may land on without wrapping into the next column.
+template<int N>
+constexpr uint64_t LandingMask(int dy) {
+	return dy > 0 ? FullMask<N>() & ~RowMask<N>(0) : dy < 0 ? FullMask<N>() & ~RowMask<N>(N - 1) : FullMask<N>();
+}
+
+template<int Step>
+inline uint64_t Shift(uint64_t bits) {
+	return Step > 0 ? bits << (Step > 0 ? Step : 0) : bits >> (Step < 0 ? -Step : 0);
+}
+
+// Kogge-Stone occluded fill: extends gen along Step through runs of pro.
+// A run is at most N - 2 discs long, so boards up to 5x5 need two shifts and larger ones three.
+template<int N, int Step, uint64_t Mask>
+inline uint64_t Fill(uint64_t gen, uint64_t pro) {
+	pro &= Mask;
+	gen |= pro & Shift<Step>(gen);
+	pro &= Shift<Step>(pro);
+	gen |= pro & Shift<2 * Step>(gen);
+	if (N > 5) {
+		pro &= Shift<2 * Step>(pro);
+		gen |= pro & Shift<4 * Step>(gen);
+	}
+	return gen;
+}
+
+template<int N, int DX, int DY>
+inline uint64_t DirectionMoves(uint64_t player, uint64_t opponent) {
+	constexpr int step = DX * N + DY;
+	constexpr uint64_t mask = LandingMask<N>(DY);
+	return Shift<step>(Fill<N, step, mask>(player, opponent) & opponent) & mask;
+}
+
+template<int N, int DX, int DY>
+inline uint64_t DirectionFlips(uint64_t move, uint64_t player, uint64_t opponent) {
+	constexpr int step = DX * N + DY;
+	constexpr uint64_t mask = LandingMask<N>(DY);
+	uint64_t run = Fill<N, step, mask>(move, opponent) & opponent;
+	uint64_t bracketed = Shift<step>(run | move) & mask & player;
+	return run & (0 - (uint64_t)(bracketed != 0));
+}
+
+// A position seen from the side to move: one mask for its discs and one for the opponent's.
+// The masks carry no size, the kernels below are specialized per board size instead.
+struct Board {
+	uint64_t player = 0;
+	uint64_t opponent = 0;
+	Board() = default;
+	Board(uint64_t player, uint64_t opponent) : player(player), opponent(opponent) {}
+	inline bool operator ==(const Board& board) const { return std::memcmp(this, &board, sizeof(Board)) == 0; }
+	inline bool operator !=(const Board& board) const { return std::memcmp(this, &board, sizeof(Board)) != 0; }
+};
+
+inline Board StartingBoard(int size) {
+	int c = size / 2;
+	return Board(SquareBit(size, { c - 1, c }) | SquareBit(size, { c, c - 1 }), SquareBit(size, { c - 1, c - 1 }) | SquareBit(size, { c, c }));
+}
+
+inline Board Pass(const Board& board) {
+	return Board(board.opponent, board.player);
+}
+
+// Every legal move of the side to move, all eight directions in one pass.
+template<int N>
+inline uint64_t LegalMoves(const Board& board) {
+	static_assert(N % 2 == 0 && N >= MIN_BOARD_SIZE && N <= MAX_BOARD_SIZE, "Unsupported board size");
+	uint64_t p = board.player, o = board.opponent;
+	uint64_t moves = DirectionMoves<N, 0, 1>(p, o) | DirectionMoves<N, 0, -1>(p, o)
+		| DirectionMoves<N, 1, 0>(p, o) | DirectionMoves<N, -1, 0>(p, o)
+		| DirectionMoves<N, 1, 1>(p, o) | DirectionMoves<N, -1, -1>(p, o)
+		| DirectionMoves<N, 1, -1>(p, o) | DirectionMoves<N, -1, 1>(p, o);
+	return moves & ~(p | o);
+}
+
+// Discs flipped by the side to move playing the single bit move on an empty square.
+template<int N>
+inline uint64_t Flips(const Board& board, uint64_t move) {
+	uint64_t p = board.player, o = board.opponent;
+	return DirectionFlips<N, 0, 1>(move, p, o) | DirectionFlips<N, 0, -1>(move, p, o)
+		| DirectionFlips<N, 1, 0>(move, p, o) | DirectionFlips<N, -1, 0>(move, p, o)
+		| DirectionFlips<N, 1, 1>(move, p, o) | DirectionFlips<N, -1, -1>(move, p, o)
+		| DirectionFlips<N, 1, -1>(move, p, o) | DirectionFlips<N, -1, 1>(move, p, o);
+}
+
+// The board after the side to move plays move, seen from the other side.
+template<int N>
+inline Board Play(const Board& board, uint64_t move) {
+	uint64_t flips = Flips<N>(board, move);
+	return Board(board.opponent & ~flips, board.player | flips | move);
+}
+
+// Entry points for code outside the search, which picks the specialization for size once per call.
+inline uint64_t LegalMoves(const Board& board, int size) {
+	switch (size) {
+		case 6: return LegalMoves<6>(board);
+		case 8: return LegalMoves<8>(board);
+		default: return LegalMoves<4>(board);
+	}
+}
+
+inline uint64_t Flips(const Board& board, uint64_t move, int size) {
+	switch (size) {
+		case 6: return Flips<6>(board, move);
+		case 8: return Flips<8>(board, move);
+		default: return Flips<4>(board, move);
+	}
+}
+
+inline Board Play(const Board& board, uint64_t move, int size) {
+	uint64_t flips = Flips(board, move, size);
+	return Board(board.opponent & ~flips, board.player | flips | move);
+}
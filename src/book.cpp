@@ -0,0 +1,148 @@
+#include "book.h"
+#include "search.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <unordered_set>
+#include <vector>
+
+OpeningBook Book;
+
+// File layout: BOOK_MAGIC, then the version, the board size, the slot count and the number of
+// positions as 32 bit numbers, then the slots.
+static const char BOOK_MAGIC[8] = { 'O', 'T', 'H', 'B', 'O', 'O', 'K', '1' };
+constexpr uint32_t BOOK_VERSION = 1;
+constexpr size_t BOOK_HEADER = 24;
+
+std::string BookFile(int size) {
+	return "othello" + std::to_string(size) + "x" + std::to_string(size) + ".book";
+}
+
+bool OpeningBook::open(const std::string& path, int size) {
+	slots = nullptr;
+	this->size = 0;
+	if (!file.open(path)) return false;
+	uint32_t header[4] = { 0, 0, 0, 0 };
+	if (file.size() > BOOK_HEADER) std::memcpy(header, file.data() + sizeof(BOOK_MAGIC), sizeof(header));
+	uint32_t count = header[2];
+	if (std::memcmp(file.data(), BOOK_MAGIC, sizeof(BOOK_MAGIC)) != 0 || header[0] != BOOK_VERSION || header[1] != (uint32_t)size
+		|| count == 0 || (count & (count - 1)) != 0 || file.size() != BOOK_HEADER + (size_t)count * sizeof(BookSlot)) {
+		file.close();
+		return false;
+	}
+	slots = (const BookSlot*)(file.data() + BOOK_HEADER);
+	mask = count - 1;
+	positions = header[3];
+	this->size = size;
+	return true;
+}
+
+struct BookPosition {
+	Board board;
+	int side;
+	uint64_t key;
+};
+
+template<int N>
+static int BuildBook(int plies, const SearchLimits& limits, const SearchOptions& options, const std::string& path) {
+	auto start = std::chrono::steady_clock::now();
+	// Every position up to plies moves in, one of each set of mirror images.
+	std::vector<BookPosition> positions, layer;
+	std::unordered_set<uint64_t> seen;
+	int symmetry;
+	Board startBoard = StartingBoard(N);
+	layer.push_back({ startBoard, 0, CanonicalHash<N>(startBoard, symmetry) });
+	seen.insert(layer[0].key);
+	for (int ply = 0; ply <= plies && !layer.empty(); ply++) {
+		std::vector<BookPosition> next;
+		auto reach = [&](const Board& board, int side) {
+			uint64_t key = CanonicalHash<N>(board, symmetry);
+			if (seen.insert(key).second) next.push_back({ board, side, key });
+		};
+		for (const BookPosition& position : layer) {
+			uint64_t moves = LegalMoves<N>(position.board);
+			// Forced moves and passes are played without a search anyway, the book only needs their children.
+			if (PopCount(moves) > 1 && position.key) positions.push_back(position);
+			if (ply == plies) continue;
+			if (!moves && LegalMoves<N>(Pass(position.board))) reach(Pass(position.board), position.side ^ 1);
+			for (; moves; moves &= moves - 1) reach(Play<N>(position.board, moves & (0 - moves)), position.side ^ 1);
+		}
+		layer.swap(next);
+	}
+	std::cout << "Searching " << positions.size() << " positions of the first " << plies << " plies to depth " << limits.depth
+		<< (Patterns.getSize() == N ? " with the pattern weights." : " counting discs.") << std::endl;
+
+	uint32_t count = 1;
+	while (count < 2 * positions.size()) count *= 2;
+	std::vector<BookSlot> slots(count, BookSlot{ 0, 0, NO_MOVE, 0, 0 });
+	for (size_t i = 0; i < positions.size(); i++) {
+		const BookPosition& position = positions[i];
+		SearchResult result = MiniMaxDecision<N>(position.board, position.side, limits, options);
+		CanonicalBoard<N>(position.board, symmetry);
+		uint32_t slot = (uint32_t)position.key & (count - 1);
+		while (slots[slot].key) slot = (slot + 1) & (count - 1);
+		slots[slot] = BookSlot{ position.key, (int16_t)result.score, TransformSquare<N>((uint8_t)LowestSquare(result.move), symmetry), (uint8_t)result.depth, 0 };
+		if ((i + 1) % 100 == 0) std::cout << (i + 1) << " of " << positions.size() << " searched." << std::endl;
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::ofstream out(path, std::ios::binary);
+	uint32_t header[4] = { BOOK_VERSION, (uint32_t)N, count, (uint32_t)positions.size() };
+	out.write(BOOK_MAGIC, sizeof(BOOK_MAGIC));
+	out.write((const char*)header, sizeof(header));
+	out.write((const char*)slots.data(), slots.size() * sizeof(BookSlot));
+	if (!out) {
+		std::cerr << "Could not write " << path << "." << std::endl;
+		return 1;
+	}
+	std::cout << "Built a book of " << positions.size() << " positions in " << seconds << "s. Wrote " << count << " slots to " << path << "." << std::endl;
+	return 0;
+}
+
+int RunBookBuilder(int argc, char** args) {
+	int size = 8;
+	int plies = 6;
+	std::string path;
+	std::string weights;
+	SearchLimits limits;
+	limits.seconds = 0;
+	limits.depth = 10;
+	SearchOptions options;
+	options.threads = HardwareThreads();
+	for (int i = 2; i < argc; i++) {
+		std::string option = args[i];
+		if (option == "--size" && i + 1 < argc) size = std::atoi(args[++i]);
+		else if (option == "--plies" && i + 1 < argc) plies = std::atoi(args[++i]);
+		else if (option == "--depth" && i + 1 < argc) limits.depth = std::atoi(args[++i]);
+		else if (option == "--threads" && i + 1 < argc) options.threads = std::atoi(args[++i]);
+		else if (option == "--out" && i + 1 < argc) path = args[++i];
+		else if (option == "--weights" && i + 1 < argc) weights = args[++i];
+		else {
+			std::cerr << "Usage: " << args[0] << " book [--size 6|8] [--plies <count>] [--depth <plies>] [--threads <count>] [--weights <file>] [--out <file>]" << std::endl;
+			return 2;
+		}
+	}
+	if (!IsSupportedBoardSize(size)) {
+		std::cerr << "Invalid board size: " << size << ".\n    Valid board sizes are: 4, 6 and 8." << std::endl;
+		return 2;
+	}
+	if (plies < 0 || limits.depth <= 0 || limits.depth > 60 || options.threads <= 0) {
+		std::cerr << "Invalid book settings: the plies are zero or more, the depth 1 to 60 and the threads one or more." << std::endl;
+		return 2;
+	}
+	if (path.empty()) path = BookFile(size);
+	// The book searches with the pattern weights the game would use, the disc count without them.
+	if (!Patterns.load(weights.empty() ? WeightsFile(size) : weights, size) && !weights.empty()) {
+		std::cerr << "Invalid weights: " << weights << "." << std::endl;
+		return 2;
+	}
+
+	switch (size) {
+		case 6: return BuildBook<6>(plies, limits, options, path);
+		case 8: return BuildBook<8>(plies, limits, options, path);
+		default: return BuildBook<4>(plies, limits, options, path);
+	}
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+#include "bitboard.h"
+#include "mapped.h"
+#include "symmetry.h"
+#include "transposition.h"
+
+// Opening book: the searched score and best move of every position in the first plies of the
+// game, built once by `othello book` and mapped into memory by the game, which plays from it
+// before it searches. Processes playing on the same machine share the pages of the file.
+//
+// The file is an open addressing hash table keyed by the canonical hash, so mirror images of a
+// position share its entry, and moves are stored in the canonical board's squares.
+struct BookEntry {
+	int score = 0; // For the side to move, from a search to depth plies.
+	int depth = 0;
+	uint8_t move = NO_MOVE;
+};
+
+// One slot of the table as stored in the file, key 0 marks an empty slot.
+struct BookSlot {
+	uint64_t key;
+	int16_t score;
+	uint8_t move;
+	uint8_t depth;
+	uint32_t unused;
+};
+
+// Where the game and the builder look for the book of a board size by default.
+std::string BookFile(int size);
+
+class OpeningBook {
+public:
+	// Maps the file at path, false if it is missing or not a book for boards of size.
+	bool open(const std::string& path, int size);
+	inline bool isOpen() const { return slots != nullptr; }
+	inline int getSize() const { return size; }
+	inline uint32_t getPositions() const { return positions; }
+
+	// Looks board up, false if the book does not have it or is for another board size.
+	template<int N>
+	bool probe(const Board& board, BookEntry& entry) const;
+
+private:
+	MappedFile file;
+	const BookSlot* slots = nullptr;
+	uint32_t mask = 0; // Slot count minus one, the count is a power of two.
+	uint32_t positions = 0;
+	int size = 0;
+};
+
+template<int N>
+bool OpeningBook::probe(const Board& board, BookEntry& entry) const {
+	if (size != N) return false;
+	int symmetry;
+	uint64_t key = CanonicalHash<N>(board, symmetry);
+	// The table is at most half full, so a probe rarely looks past its home slot.
+	for (uint32_t slot = (uint32_t)key & mask; slots[slot].key; slot = (slot + 1) & mask) {
+		if (slots[slot].key != key) continue;
+		entry.score = slots[slot].score;
+		entry.depth = slots[slot].depth;
+		entry.move = InverseSquare<N>(slots[slot].move, symmetry);
+		return true;
+	}
+	return false;
+}
+
+// Loaded by the game, probed by MiniMaxDecision before it searches.
+extern OpeningBook Book;
+
+// Searches every position of the first plies and writes the book, run as:
+// othello book [--size 6|8] [--plies <count>] [--depth <plies>] [--threads <count>] [--weights <file>] [--out <file>]
+int RunBookBuilder(int argc, char** args);
@@ -0,0 +1,101 @@
+#pragma once
+#include <cstdint>
+#include <initializer_list>
+
+#include "bitboard.h"
+
+// The endgame solver takes over from the depth limited search wherever the remaining depth
+// reaches every empty square, so the search below is exact anyway. Its last few empties are
+// solved straight off the board here, without a move list, a hash or an undo stack.
+constexpr int LAST_EMPTIES = 4;
+// Above this many empties the solver sorts moves fastest first, by the opponent's mobility.
+constexpr int FASTEST_FIRST_EMPTIES = 6;
+
+template<int N>
+constexpr uint64_t CornerMask() {
+	return 1ULL | 1ULL << (N - 1) | 1ULL << (N * (N - 1)) | 1ULL << (N * N - 1);
+}
+
+template<int N>
+inline int Empties(const Board& board) {
+	return SquareCount<N>() - PopCount(board.player | board.opponent);
+}
+
+// The squares of one quadrant: bit 0 of quadrant picks the lower or upper half of x, bit 1 of y.
+template<int N>
+constexpr uint64_t QuadrantMask(int quadrant, int square = 0) {
+	return square == N * N ? 0
+		: ((square / N < N / 2) != ((quadrant & 1) != 0) && (square % N < N / 2) != ((quadrant & 2) != 0) ? 1ULL << square : 0)
+		| QuadrantMask<N>(quadrant, square + 1);
+}
+
+// The empty squares in quadrants with an odd number of empties. Playing there first tends to
+// leave the last move of each region to the side to move, the parity heuristic.
+template<int N>
+inline uint64_t OddQuadrants(uint64_t empties) {
+	constexpr uint64_t quadrants[4] = { QuadrantMask<N>(0), QuadrantMask<N>(1), QuadrantMask<N>(2), QuadrantMask<N>(3) };
+	uint64_t odd = 0;
+	for (uint64_t quadrant : quadrants) {
+		if (PopCount(empties & quadrant) & 1) odd |= quadrant;
+	}
+	return odd & empties;
+}
+
+// Final disc difference with E empty squares left, the squares given as the mask empties.
+// Fail-soft within (alpha, beta) like the search, nodes counts every position visited.
+template<int N, int E>
+struct LastEmpties {
+	static int solve(const Board& board, uint64_t empties, int alpha, int beta, uint64_t& nodes);
+};
+
+template<int N, int E>
+int LastEmpties<N, E>::solve(const Board& board, uint64_t empties, int alpha, int beta, uint64_t& nodes) {
+	constexpr int NONE = -SquareCount<N>() - 1; // Below any score, no move played yet.
+	nodes++;
+	uint64_t odd = OddQuadrants<N>(empties);
+	int best = NONE;
+	for (uint64_t squares : { odd, empties & ~odd }) {
+		for (; squares; squares &= squares - 1) {
+			uint64_t move = squares & (0 - squares);
+			uint64_t flips = Flips<N>(board, move);
+			if (!flips) continue;
+			Board next(board.opponent ^ flips, board.player ^ flips ^ move);
+			int value = -LastEmpties<N, E - 1>::solve(next, empties ^ move, -beta, -(alpha > best ? alpha : best), nodes);
+			if (value > best) {
+				best = value;
+				if (value >= beta) return value;
+			}
+		}
+	}
+	if (best != NONE) return best;
+	Board passed = Pass(board);
+	if (!LegalMoves<N>(passed)) return PopCount(board.player) - PopCount(board.opponent);
+	return -solve(passed, empties, -beta, -alpha, nodes);
+}
+
+// One empty square: whoever can play it does, there is nothing to choose.
+template<int N>
+struct LastEmpties<N, 1> {
+	static int solve(const Board& board, uint64_t empties, int /*alpha*/, int /*beta*/, uint64_t& nodes) {
+		nodes++;
+		int difference = PopCount(board.player) - PopCount(board.opponent);
+		int flips = PopCount(Flips<N>(board, empties));
+		if (flips) return difference + 2 * flips + 1;
+		flips = PopCount(Flips<N>(Pass(board), empties));
+		if (flips) return difference - 2 * flips - 1;
+		return difference;
+	}
+};
+
+// Solves any of the last LAST_EMPTIES empties.
+template<int N>
+inline int SolveLastEmpties(const Board& board, int alpha, int beta, uint64_t& nodes) {
+	uint64_t empties = FullMask<N>() & ~(board.player | board.opponent);
+	switch (PopCount(empties)) {
+		case 0: nodes++; return PopCount(board.player) - PopCount(board.opponent);
+		case 1: return LastEmpties<N, 1>::solve(board, empties, alpha, beta, nodes);
+		case 2: return LastEmpties<N, 2>::solve(board, empties, alpha, beta, nodes);
+		case 3: return LastEmpties<N, 3>::solve(board, empties, alpha, beta, nodes);
+		default: return LastEmpties<N, 4>::solve(board, empties, alpha, beta, nodes);
+	}
+}
@@ -0,0 +1,60 @@
+#include "engine.h"
+
+EngineThread::EngineThread() : worker(&EngineThread::loop, this) {}
+
+EngineThread::~EngineThread() {
+	shutdown();
+}
+
+void EngineThread::start(Decision decide, const Board& board, int size, int side, const SearchLimits& limits, const SearchOptions& options) {
+	std::lock_guard<std::mutex> lock(mutex);
+	job.decide = decide;
+	job.board = board;
+	job.size = size;
+	job.side = side;
+	job.limits = limits;
+	job.limits.stop = &stopSearch;
+	job.options = options;
+	stopSearch = false;
+	hasJob = true;
+	busy = true;
+	wake.notify_one();
+}
+
+bool EngineThread::poll(SearchResult& result) {
+	std::lock_guard<std::mutex> lock(mutex);
+	if (!hasResult) return false;
+	result = this->result;
+	hasResult = false;
+	busy = false;
+	return true;
+}
+
+void EngineThread::stop() {
+	stopSearch = true;
+}
+
+void EngineThread::shutdown() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		quit = true;
+		stopSearch = true;
+		wake.notify_one();
+	}
+	if (worker.joinable()) worker.join();
+}
+
+void EngineThread::loop() {
+	std::unique_lock<std::mutex> lock(mutex);
+	for (;;) {
+		wake.wait(lock, [this]() { return hasJob || quit; });
+		if (quit) return;
+		Job current = job;
+		hasJob = false;
+		lock.unlock();
+		SearchResult answer = current.decide(current.board, current.size, current.side, current.limits, current.options);
+		lock.lock();
+		result = answer;
+		hasResult = true;
+	}
+}
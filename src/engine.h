@@ -0,0 +1,52 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "search.h"
+
+// A move decision the engine can run: MiniMaxDecision or MonteCarloDecision.
+using Decision = SearchResult(*)(const Board& board, int size, int side, const SearchLimits& limits, const SearchOptions& options);
+
+// Runs move decisions on a worker thread so the render loop keeps drawing and polling input.
+// The game posts a position with start() and picks the answer up with poll() on a later frame.
+class EngineThread {
+public:
+	EngineThread();
+	~EngineThread();
+
+	// Queues a search of board by decide, the previous search must have been picked up first.
+	void start(Decision decide, const Board& board, int size, int side, const SearchLimits& limits, const SearchOptions& options);
+	// Returns true, once, when the queued search has finished and writes its answer to result.
+	bool poll(SearchResult& result);
+	// Cuts the running search short, its best move so far is still published.
+	void stop();
+	// Stops the running search and joins the worker, called before the game shuts down.
+	void shutdown();
+
+	inline bool isBusy() const { return busy; }
+
+private:
+	struct Job {
+		Decision decide = nullptr;
+		Board board;
+		int size = 0;
+		int side = 0;
+		SearchLimits limits;
+		SearchOptions options;
+	};
+
+	std::mutex mutex;
+	std::condition_variable wake;
+	Job job;
+	SearchResult result;
+	bool hasJob = false;
+	bool hasResult = false;
+	bool quit = false;
+	bool busy = false; // From start() until the answer is picked up by poll(), only used by the game thread.
+	std::atomic<bool> stopSearch{ false };
+	std::thread worker; // Last, so everything loop() touches exists before it starts.
+
+	void loop();
+};
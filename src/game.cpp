@@ -1,113 +1,102 @@
 #include "game.h"
+#include "book.h"
+#include "engine.h"
+#include "mcts.h"
+#include "pattern.h"
+#include "search.h"
+#include "solved.h"
 
 #include <algorithm>
 #include <chrono>
-#include <cstring>
+#include <cstdlib>
 #include <iostream>
 
-using Clock = std::chrono::high_resolution_clock;
-
 PlayerType GetPlayerType(const std::string& type) {
 	if (type == "human") return PlayerType::HUMAN;
 	if (type == "minimax") return PlayerType::MINIMAX;
+	if (type == "mcts") return PlayerType::MCTS;
 	return PlayerType::NONE;
 }
 
 
-Board::Board(const Board& board, const glm::ivec2& placement, Piece piece) {
-	for (int x = 0; x < 4; x++) { // Copy the board over.
-		for (int y = 0; y < 4; y++) {
-			this->pieces[x][y] = board.pieces[x][y];
-		}
-	}
-	
-	if (board.pieces[placement.x][placement.y] == Piece::NONE && InBoard(placement)) {
-		for (Directions dir : Dirs) {
-			glm::ivec2 loopPos = placement;
-			MoveByDirection(loopPos, dir);
-			if (board.pieces[loopPos.x][loopPos.y] != (piece == Piece::DARK ? Piece::LIGHT : Piece::DARK)) continue;
-			while (InBoard(loopPos) && board.pieces[loopPos.x][loopPos.y] != piece && board.pieces[loopPos.x][loopPos.y] != Piece::NONE) {
-				MoveByDirection(loopPos, dir);
-			}
-			if (InBoard(loopPos)) {
-				if (board.pieces[loopPos.x][loopPos.y] == Piece::NONE) continue;
-				glm::ivec2 placePos = placement;
-				while (placePos != loopPos) {
-					this->pieces[placePos.x][placePos.y] = piece;
-					MoveByDirection(placePos, dir);
-				}
-			}
-		}
-	}
-}
-
-bool Board::operator ==(const Board& board) {
-	return std::memcmp(this->pieces, board.pieces, sizeof(Board::pieces)) == 0;
-}
-bool Board::operator !=(const Board& board) {
-	return std::memcmp(this->pieces, board.pieces, sizeof(Board::pieces)) != 0;
-}
-
 bool NoMoves = false;
 PlayerType Player1, Player2;
 Piece CurrentPiece = Piece::LIGHT;
 Piece OtherPiece = Piece::DARK;
-Board OthelloBoard;
+int BoardSize = 4;
+float TileSize = 64.0f;
+Board OthelloBoard = StartingBoard(BoardSize);
+SearchLimits Limits;
+SearchOptions Options;
+EngineThread Engine;
 int MouseX, MouseY;
 
-uint64_t Utility(const Board& board, Piece piece);
-
-void MoveByDirection(glm::ivec2& position, Directions dir) {
-	switch (dir) {
-		case Directions::N: position.y--; break;
-		case Directions::NE: position.y--; position.x++; break;
-		case Directions::E: position.x++; break;
-		case Directions::SE: position.y++; position.x++; break;
-		case Directions::S: position.y++; break;
-		case Directions::SW: position.y++; position.x--; break;
-		case Directions::W: position.x--; break;
-		case Directions::NW: position.y--; position.x--; break;
-	}
-}
+// Pondering: while a human thinks, a minimax opponent searches the position after the reply its
+// last search expected, or the human's own position when it expects none, filling the hash table.
+// If the human plays the expected reply the running search becomes the engine's answer.
+enum class PonderState { NONE, PONDERING, HIT, MISS };
+using Clock = std::chrono::steady_clock;
+bool PonderEnabled = false;
+PonderState Ponder = PonderState::NONE;
+Board PonderFrom, PonderBoard; // The human's position and the one being searched.
+bool PonderPredicted = false;
+const char* PonderPlayer = "";
+Clock::time_point PonderStart;
+double PonderSeconds = 0; // Until the human moved.
+int PonderHits = 0, PonderGuesses = 0;
 
 inline PlayerType GetCurrentPlayer() {
 	return CurrentPiece == Piece::LIGHT ? Player1 : Player2;
 }
 
-void ApplyMove(const glm::ivec2 placement, Piece piece) {
-	OthelloBoard = Board(OthelloBoard, placement, piece);
+uint64_t FlipMask(const Board& board, const glm::ivec2& placement) {
+	if (!InBoard(BoardSize, placement) || ((board.player | board.opponent) & SquareBit(BoardSize, placement))) return 0;
+	return Flips(board, SquareBit(BoardSize, placement), BoardSize);
 }
 
-std::pair<bool, Board> IsValidMove(const Board& board, const glm::ivec2& placement, Piece piece) {
-	Board b = Board(board, placement, piece);
-	return { b != board, b };
+void ApplyMove(const glm::ivec2 placement) {
+	OthelloBoard = Play(OthelloBoard, SquareBit(BoardSize, placement), BoardSize);
+}
+
+std::pair<bool, Board> IsValidMove(const Board& board, const glm::ivec2& placement) {
+	if (!InBoard(BoardSize, placement) || !(LegalMoves(board, BoardSize) & SquareBit(BoardSize, placement))) return { false, board };
+	return { true, Play(board, SquareBit(BoardSize, placement), BoardSize) };
+}
+
+inline Piece PieceAt(const Board& board, const glm::ivec2& position) {
+	if (board.player & SquareBit(BoardSize, position)) return CurrentPiece;
+	if (board.opponent & SquareBit(BoardSize, position)) return OtherPiece;
+	return Piece::NONE;
 }
 
 void RenderBoard() {
-	for (int x = -2; x < 2; x++) {
-		for (int y = 2; y > -2; y--) {
-			RenderQuad({ x, y }, x % 2 == 0 ? (y % 2 == 0 ? Textures::DARK_BOARD : Textures::LIGHT_BOARD) : (y % 2 == 0 ? Textures::LIGHT_BOARD : Textures::DARK_BOARD));
+	int half = BoardSize / 2;
+	for (int x = -half; x < half; x++) {
+		for (int y = half; y > -half; y--) {
+			RenderQuad({ x, y }, x % 2 == 0 ? (y % 2 == 0 ? Textures::DARK_BOARD : Textures::LIGHT_BOARD) : (y % 2 == 0 ? Textures::LIGHT_BOARD : Textures::DARK_BOARD), 1.0f, TileSize);
 		}
 	}
 }
 
 void RenderPieces() {
-	for (int x = 0; x < 4; x++) {
-		for (int y = 0; y < 4; y++) {
-			if (OthelloBoard.pieces[x][y] == Piece::NONE) continue;
-			RenderQuad({ x - 2, -y + 2 }, OthelloBoard.pieces[x][y] == Piece::LIGHT ? Textures::LIGHT_PIECE : Textures::DARK_PIECE);
+	int half = BoardSize / 2;
+	for (int x = 0; x < BoardSize; x++) {
+		for (int y = 0; y < BoardSize; y++) {
+			Piece piece = PieceAt(OthelloBoard, { x, y });
+			if (piece == Piece::NONE) continue;
+			RenderQuad({ x - half, -y + half }, piece == Piece::LIGHT ? Textures::LIGHT_PIECE : Textures::DARK_PIECE, 1.0f, TileSize);
 		}
 	}
 
 	// Render mouse move.
 	if (GetCurrentPlayer() == PlayerType::HUMAN && !NoMoves) {
-		auto change = IsValidMove(OthelloBoard, { MouseX, MouseY }, CurrentPiece);
-		auto& board = change.second;
+		auto change = IsValidMove(OthelloBoard, { MouseX, MouseY });
 		if (change.first) {
-			for (int x = 0; x < 4; x++) {
-				for (int y = 0; y < 4; y++) {
-					if (board.pieces[x][y] != OthelloBoard.pieces[x][y]) {
-						RenderQuad({ x - 2, -y + 2 }, board.pieces[x][y] == Piece::LIGHT ? Textures::LIGHT_PIECE : Textures::DARK_PIECE, .6f);
+			uint64_t changed = change.second.opponent & ~OthelloBoard.player; // The placed disc and every flip.
+			for (int x = 0; x < BoardSize; x++) {
+				for (int y = 0; y < BoardSize; y++) {
+					if (changed & SquareBit(BoardSize, { x, y })) {
+						RenderQuad({ x - half, -y + half }, CurrentPiece == Piece::LIGHT ? Textures::LIGHT_PIECE : Textures::DARK_PIECE, .6f, TileSize);
 					}
 				}
 			}
@@ -115,8 +104,8 @@ void RenderPieces() {
 	}
 
 	if (NoMoves) { // The game has ended.
-		uint64_t p1Score = Utility(OthelloBoard, Piece::LIGHT);
-		uint64_t p2Score = Utility(OthelloBoard, Piece::DARK);
+		uint64_t p1Score = Utility(CurrentPiece == Piece::LIGHT ? OthelloBoard : Pass(OthelloBoard));
+		uint64_t p2Score = Utility(CurrentPiece == Piece::DARK ? OthelloBoard : Pass(OthelloBoard));
 		if (p1Score > p2Score) {
 			RenderText("Player 1 has won with a score of " + std::to_string(p1Score) + ".", { 0.0f, 200.0f });
 		} else if (p2Score > p1Score) {
@@ -134,15 +123,15 @@ void SwapCurrentPiece() {
 }
 
 void GameMouseMoveCallback(double x, double y) {
-	x = (-720.0 / 2.0 + x) + 128.; // Convert x coord from 0->width to -width/2 -> width/2 and then move x=0 to the left of board.
-	y =  (480.0 / 2.0 - y) - 128.; // Same as x, but with height and y = 0 to the top of board.
-	MouseX = x / 64; // Calculate tile coordinates.
-	MouseY = -y / 64;
+	x = (-720.0 / 2.0 + x) + BoardSize / 2 * TileSize; // Convert x coord from 0->width to -width/2 -> width/2 and then move x=0 to the left of board.
+	y =  (480.0 / 2.0 - y) - BoardSize / 2 * TileSize; // Same as x, but with height and y = 0 to the top of board.
+	MouseX = x / TileSize; // Calculate tile coordinates.
+	MouseY = -y / TileSize;
 }
 
 void GameMouseButtonCallback(bool pressed) {
-	if (!pressed && !NoMoves && GetCurrentPlayer() == PlayerType::HUMAN) {
-		ApplyMove({ MouseX, MouseY }, CurrentPiece);
+	if (!pressed && !NoMoves && GetCurrentPlayer() == PlayerType::HUMAN && FlipMask(OthelloBoard, { MouseX, MouseY })) {
+		ApplyMove({ MouseX, MouseY });
 		SwapCurrentPiece();
 	}
 }
@@ -153,116 +142,224 @@ bool ObtainPlayers(char** args) {
 	Player2 = GetPlayerType(args[2]);
 
 	if (Player1 == PlayerType::NONE) {
-		std::cerr << "Invalid player_type: " << args[1] << ".\n    Valid player_types are: human and minimax." << std::endl;
+		std::cerr << "Invalid player_type: " << args[1] << ".\n    Valid player_types are: human, minimax and mcts." << std::endl;
 		return false;
 	}
 	if (Player2 == PlayerType::NONE) {
-		std::cerr << "Invalid player_type: " << args[2] << ".\n    Valid player_types are: human and minimax." << std::endl;
+		std::cerr << "Invalid player_type: " << args[2] << ".\n    Valid player_types are: human, minimax and mcts." << std::endl;
 		return false;
 	}
 
 	return true;
 }
 
-std::vector<Board> Successors(const Board& board, Piece piece) {
-	std::vector<Board> successors;
-	std::vector<std::pair<bool, Board>> all;
-	all.reserve(16);
-	successors.reserve(16);
-	for (int x = 0; x < 4; x++) {
-		for (int y = 0; y < 4; y++) {
-			all.push_back(IsValidMove(board, {x, y}, piece));
+bool ObtainOptions(int argc, char** args) {
+	Options.threads = HardwareThreads();
+	std::string solvedPath = SOLVED_FILE;
+	bool solvedGiven = false;
+	std::string bookPath;
+	std::string weightsPath;
+	for (int i = 3; i < argc; i++) {
+		std::string option = args[i];
+		if (option == "--size" && i + 1 < argc) {
+			BoardSize = std::atoi(args[++i]);
+			if (!IsSupportedBoardSize(BoardSize)) {
+				std::cerr << "Invalid board size: " << args[i] << ".\n    Valid board sizes are: 4, 6 and 8." << std::endl;
+				return false;
+			}
+		} else if (option == "--hash" && i + 1 < argc) {
+			int megabytes = std::atoi(args[++i]);
+			if (megabytes <= 0) {
+				std::cerr << "Invalid hash size: " << args[i] << ".\n    The hash size is a positive number of megabytes." << std::endl;
+				return false;
+			}
+			TransTable.resize(megabytes);
+		} else if (option == "--time" && i + 1 < argc) {
+			Limits.seconds = std::atof(args[++i]);
+			if (Limits.seconds < 0) {
+				std::cerr << "Invalid move time: " << args[i] << ".\n    The move time is a number of seconds, 0 searches without a time limit." << std::endl;
+				return false;
+			}
+		} else if (option == "--nodes" && i + 1 < argc) {
+			Limits.nodes = std::strtoull(args[++i], nullptr, 10);
+		} else if (option == "--search" && i + 1 < argc) {
+			if (!ParseSearchAlgorithm(args[++i], Options.algorithm)) {
+				std::cerr << "Invalid search algorithm: " << args[i] << ".\n    Valid search algorithms are: alphabeta and pvs." << std::endl;
+				return false;
+			}
+		} else if (option == "--ordering" && i + 1 < argc) {
+			if (!ParseOrdering(args[++i], Options.ordering)) {
+				std::cerr << "Invalid move ordering: " << args[i] << ".\n    Give a comma separated list of tt, killers, history and squares, or none." << std::endl;
+				return false;
+			}
+		} else if (option == "--threads" && i + 1 < argc) {
+			Options.threads = std::atoi(args[++i]);
+			if (Options.threads <= 0) {
+				std::cerr << "Invalid thread count: " << args[i] << ".\n    The thread count is a positive number." << std::endl;
+				return false;
+			}
+		} else if (option == "--solve" && i + 1 < argc) {
+			Options.solveEmpties = std::atoi(args[++i]);
+		} else if (option == "--driver" && i + 1 < argc) {
+			if (!ParseSearchDriver(args[++i], Options.driver)) {
+				std::cerr << "Invalid search driver: " << args[i] << ".\n    Valid search drivers are: full, aspiration and mtdf." << std::endl;
+				return false;
+			}
+		} else if (option == "--parallel" && i + 1 < argc) {
+			if (!ParseParallelSearch(args[++i], Options.parallel)) {
+				std::cerr << "Invalid parallel search: " << args[i] << ".\n    Valid parallel searches are: rootsplit, lazysmp and ybwc." << std::endl;
+				return false;
+			}
+		} else if (option == "--solved" && i + 1 < argc) {
+			solvedPath = args[++i];
+			solvedGiven = true;
+		} else if (option == "--book" && i + 1 < argc) {
+			bookPath = args[++i];
+		} else if (option == "--eval" && i + 1 < argc) {
+			if (!ParseEvaluation(args[++i], Options.evaluation)) {
+				std::cerr << "Invalid evaluation: " << args[i] << ".\n    Valid evaluations are: discs and patterns." << std::endl;
+				return false;
+			}
+		} else if (option == "--weights" && i + 1 < argc) {
+			weightsPath = args[++i];
+		} else if (option == "--ponder") {
+			PonderEnabled = true;
+		} else if (option == "--playouts" && i + 1 < argc) {
+			if (!ParsePlayoutKernel(args[++i], Options.playouts)) {
+				std::cerr << "Invalid playout kernel: " << args[i] << ".\n    Valid playout kernels are: scalar and avx2." << std::endl;
+				return false;
+			}
+		} else {
+			std::cerr << "Unknown option: " << option << "." << std::endl;
+			return false;
 		}
 	}
-	all.erase(
-		std::remove_if(all.begin(), all.end(), [](const std::pair<bool, Board>& p) { return !p.first; }),
-		all.end()
-	);
-	std::transform(all.begin(), all.end(), std::back_inserter(successors), [](const std::pair<bool, Board>& p) { return p.second; });
-	return successors;
-}
 
-std::pair<Board, uint64_t> MaxValue(const Board& b);
-std::pair<Board, uint64_t> MinValue(const Board& b);
+	// The default database is optional, without it the minimax player searches 4x4 like any other size.
+	if (BoardSize == 4 && !SolvedGame.open(solvedPath) && solvedGiven) {
+		std::cerr << "Invalid solved database: " << solvedPath << ".\n    Build one with: " << args[0] << " solve --out " << solvedPath << std::endl;
+		return false;
+	}
 
-bool IsTerminal(const Board& board, const std::vector<Board>& successors, Piece otherPiece) {
-	return successors.empty() && Successors(board, otherPiece).empty();
-}
+	// The same goes for the opening book.
+	if (!Book.open(bookPath.empty() ? BookFile(BoardSize) : bookPath, BoardSize) && !bookPath.empty()) {
+		std::cerr << "Invalid opening book: " << bookPath << ".\n    Build one with: " << args[0] << " book --size " << BoardSize << " --out " << bookPath << std::endl;
+		return false;
+	}
 
-uint64_t Utility(const Board& board, Piece piece) {
-	uint64_t count = 0;
-	for (int x = 0; x < 4; x++) {
-		for (int y = 0; y < 4; y++) {
-			if (board.pieces[x][y] == piece) count++;
-		}
+	// And for the pattern weights, the search counts discs without them.
+	if (!Patterns.load(weightsPath.empty() ? WeightsFile(BoardSize) : weightsPath, BoardSize) && !weightsPath.empty()) {
+		std::cerr << "Invalid weights: " << weightsPath << ".\n    Train them with: " << args[0] << " train --size " << BoardSize << " --out " << weightsPath << std::endl;
+		return false;
 	}
-	return count;
+
+	TileSize = BoardSize > 6 ? 48.0f : 64.0f; // Keep the 8x8 board inside the 480 pixel tall window.
+	OthelloBoard = StartingBoard(BoardSize);
+	return true;
 }
 
-std::pair<Board, uint64_t> MaxValue(const Board& b) {
-	auto successors = Successors(b, CurrentPiece);
-	if (IsTerminal(b, successors, OtherPiece) || successors.empty()) {
-		return std::pair<Board, uint64_t>{b, Utility(b, CurrentPiece)};
-	}
-	std::vector<std::pair<Board, uint64_t>> minValues;
-	minValues.reserve(successors.size());
-	std::transform(successors.begin(), successors.end(), std::back_inserter(minValues), [](const Board& board) {
-		return MinValue(board);
-	});
-	auto maximum = std::max_element(minValues.begin(), minValues.end(), [](const std::pair<Board, uint64_t>& p1, const std::pair<Board, uint64_t>& p2) { return p1.second < p2.second; });
-	
-	return std::pair<Board, uint64_t>{b, maximum->second};
+inline double SecondsSince(Clock::time_point start) {
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void StartPonder() {
+	int side = CurrentPiece == Piece::DARK;
+	uint64_t expected = HashMove(OthelloBoard, BoardSize, side);
+	PonderFrom = OthelloBoard;
+	PonderPredicted = expected != 0;
+	PonderBoard = PonderPredicted ? Play(OthelloBoard, expected, BoardSize) : OthelloBoard;
+	PonderPlayer = CurrentPiece == Piece::LIGHT ? "Player 2" : "Player 1";
+	SearchLimits limits = Limits;
+	limits.seconds = 0; // Until the human moves.
+	Engine.start(MiniMaxDecision, PonderBoard, BoardSize, PonderPredicted ? side ^ 1 : side, limits, Options);
+	PonderStart = Clock::now();
+	Ponder = PonderState::PONDERING;
 }
 
-std::pair<Board, uint64_t> MinValue(const Board& b) {
-	auto successors = Successors(b, OtherPiece);
-	if (IsTerminal(b, successors, CurrentPiece) || successors.empty()) {
-		return std::pair<Board, uint64_t>{b, Utility(b, CurrentPiece)};
+void PonderHumanMoved() {
+	PonderSeconds = SecondsSince(PonderStart);
+	if (PonderPredicted) PonderGuesses++;
+	// A hit only counts when the engine has a move to play: on a pass the search would be left
+	// running with no move, and its result taken for the engine's next turn.
+	if (PonderPredicted && OthelloBoard == PonderBoard && LegalMoves(PonderBoard, BoardSize)) {
+		PonderHits++;
+		Ponder = PonderState::HIT;
+	} else {
+		Engine.stop();
+		Ponder = PonderState::MISS;
 	}
-	std::vector<std::pair<Board, uint64_t>> maxValues;
-	maxValues.reserve(successors.size());
-	std::transform(successors.begin(), successors.end(), std::back_inserter(maxValues), [](const Board& board) {
-		return MaxValue(board);
-	});
-	auto minimum = std::min_element(maxValues.begin(), maxValues.end(), [](const std::pair<Board, uint64_t>& p1, const std::pair<Board, uint64_t>& p2) { return p1.second < p2.second; });
-
-	return std::pair<Board, uint64_t>{b, minimum->second};
 }
 
-Board MiniMaxDecision() {
-	auto successors = Successors(OthelloBoard, CurrentPiece);
-	if (IsTerminal(OthelloBoard, successors, OtherPiece) || successors.empty()) {
-		return OthelloBoard;
+// searchSeconds is how long the search that pondered ran in all, on a hit.
+void ReportPonder(double searchSeconds) {
+	std::cout << PonderPlayer << " pondered " << PonderSeconds << "s on ";
+	if (!PonderPredicted) {
+		std::cout << "every reply." << std::endl;
+		return;
 	}
-	std::vector<std::pair<Board, uint64_t>> minValues;
-	minValues.reserve(successors.size());
-	std::transform(successors.begin(), successors.end(), std::back_inserter(minValues), [](const Board& board) {
-		return MinValue(board);
-	});
-	auto maximum = std::max_element(minValues.begin(), minValues.end(), [](const std::pair<Board, uint64_t>& p1, const std::pair<Board, uint64_t>& p2) { return p1.second < p2.second; });
-	
-	return maximum->first;
+	std::cout << "the expected reply: ";
+	if (Ponder == PonderState::HIT) std::cout << "ponder hit, " << std::min(PonderSeconds, searchSeconds) << "s saved";
+	else std::cout << "ponder miss";
+	std::cout << " (" << PonderHits << " of " << PonderGuesses << " guesses right)." << std::endl;
 }
 
 void Update() {
-	static Clock::time_point lastTime = Clock::now();
-	static double elapsed = 0.0;
-	auto currentTime = Clock::now();
-	elapsed += (currentTime - lastTime).count() / 1000000000.;
-	lastTime = currentTime;
+	if (Ponder == PonderState::PONDERING && OthelloBoard != PonderFrom) PonderHumanMoved();
+	if (Ponder == PonderState::MISS) {
+		SearchResult discarded;
+		if (!Engine.poll(discarded)) return; // The stopped search is still unwinding.
+		ReportPonder(0);
+		Ponder = PonderState::NONE;
+	}
 	if (NoMoves) return;
-	if (Successors(OthelloBoard, CurrentPiece).empty()) {
-		if (Successors(OthelloBoard, OtherPiece).empty())
+	if (!LegalMoves(OthelloBoard, BoardSize)) {
+		if (!LegalMoves(Pass(OthelloBoard), BoardSize))
 			NoMoves = true;
-		else SwapCurrentPiece();
+		else {
+			OthelloBoard = Pass(OthelloBoard);
+			SwapCurrentPiece();
+		}
 		return;
 	}
 	PlayerType currentPlayer = CurrentPiece == Piece::LIGHT ? Player1 : Player2;
-	if (currentPlayer == PlayerType::MINIMAX) {
-		if (elapsed >= .4) {
-			OthelloBoard = MiniMaxDecision();
-			SwapCurrentPiece();
-			elapsed = 0.;
+	PlayerType otherPlayer = CurrentPiece == Piece::LIGHT ? Player2 : Player1;
+	if (currentPlayer == PlayerType::HUMAN && otherPlayer == PlayerType::MINIMAX && PonderEnabled && Ponder == PonderState::NONE && !Engine.isBusy()) {
+		StartPonder();
+		return;
+	}
+	if (currentPlayer == PlayerType::MINIMAX || currentPlayer == PlayerType::MCTS) {
+		SearchResult result;
+		// On a ponder hit the search already running gets the move time counted from the start of pondering.
+		if (Ponder == PonderState::HIT && Limits.seconds > 0 && SecondsSince(PonderStart) >= Limits.seconds) Engine.stop();
+		if (!Engine.isBusy()) {
+			Decision decide = MiniMaxDecision;
+			if (currentPlayer == PlayerType::MCTS) decide = MonteCarloDecision;
+			Engine.start(decide, OthelloBoard, BoardSize, CurrentPiece == Piece::DARK, Limits, Options);
+			return;
 		}
-	} else elapsed = 0.;
+		if (!Engine.poll(result)) return; // Still thinking, keep drawing frames.
+		if (Ponder == PonderState::HIT) {
+			ReportPonder(result.seconds);
+			Ponder = PonderState::NONE;
+		}
+		const char* player = CurrentPiece == Piece::LIGHT ? "Player 1" : "Player 2";
+		if (currentPlayer == PlayerType::MCTS) {
+			std::cout << player << " played " << result.playouts << " playouts (" << (uint64_t)(result.seconds > 0 ? result.playouts / result.seconds : 0)
+				<< "/s) into a tree of " << result.nodes << " nodes, win rate " << result.score << "%." << std::endl;
+		} else if (result.book) {
+			std::cout << player << " played from the opening book, score " << result.score << " at depth " << result.depth << "." << std::endl;
+		} else if (result.solved) {
+			std::cout << player << " looked its move up in the solved database, score " << result.score << "." << std::endl;
+		} else {
+			std::cout << player << " searched to depth " << result.depth << (result.exact ? " (exact)" : "")
+				<< ", score " << result.score << ", " << result.nodes << " nodes in " << result.seconds << "s, "
+				<< (result.cutoffs ? 100 * result.firstMoveCutoffs / result.cutoffs : 0) << "% of cutoffs on the first move." << std::endl;
+		}
+		OthelloBoard = Play(OthelloBoard, result.move, BoardSize);
+		SwapCurrentPiece();
+	}
+}
+
+void GameShutdown() {
+	Engine.shutdown();
 }
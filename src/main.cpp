@@ -1,8 +1,12 @@
 #include <iostream>
 #include <chrono>
 
+#include "bench.h"
+#include "book.h"
 #include "game.h"
+#include "pattern.h"
 #include "renderer.h"
+#include "solved.h"
 
 #include <glm/glm.hpp>
 #include <glad/glad.h>
@@ -28,12 +32,17 @@ void SetupGLFWEventCallbacks(GLFWwindow* window) {
 }
 
 int main(int argc, char** args) {
+    if (argc >= 2 && std::string(args[1]) == "bench") return RunBenchmark(argc, args);
+    if (argc >= 2 && std::string(args[1]) == "book") return RunBookBuilder(argc, args);
+    if (argc >= 2 && std::string(args[1]) == "train") return RunTrainer(argc, args);
+    if (argc >= 2 && std::string(args[1]) == "solve") return RunSolver(argc, args);
+
     if (argc < 3) {
-        std::cerr << "Usage: " << args[0] << " <player_type> <player_type>" << std::endl;
+        std::cerr << "Usage: " << args[0] << " <player_type> <player_type> [--size 4|6|8] [--hash <megabytes>] [--time <seconds>] [--nodes <count>] [--search alphabeta|pvs] [--ordering <list>] [--threads <count>] [--parallel rootsplit|lazysmp|ybwc] [--driver full|aspiration|mtdf] [--solve <empties>] [--playouts scalar|avx2] [--ponder] [--solved <file>] [--book <file>] [--eval discs|patterns] [--weights <file>]" << std::endl;
         return 2;
     }
 
-    if (!ObtainPlayers(args)) return 2;
+    if (!ObtainPlayers(args) || !ObtainOptions(argc, args)) return 2;
 
     if (glfwInit() == GLFW_FALSE) {
         std::cerr << "GLFW failed to initialize. Likely no graphics device found.\n";
@@ -95,6 +104,7 @@ int main(int argc, char** args) {
             _SLEEP(1);
         }
     }
+    GameShutdown();
     RendererShutdown();
     glfwDestroyWindow(window);
     glfwTerminate();
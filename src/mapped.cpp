@@ -0,0 +1,76 @@
+#include "mapped.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+	close();
+}
+
+#ifdef _WIN32
+bool MappedFile::open(const std::string& path) {
+	close();
+	HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (handle == INVALID_HANDLE_VALUE) return false;
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(handle, &fileSize) || fileSize.QuadPart == 0) {
+		CloseHandle(handle);
+		return false;
+	}
+	HANDLE view = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!view) {
+		CloseHandle(handle);
+		return false;
+	}
+	bytes = (const unsigned char*)MapViewOfFile(view, FILE_MAP_READ, 0, 0, 0);
+	if (!bytes) {
+		CloseHandle(view);
+		CloseHandle(handle);
+		return false;
+	}
+	file = handle;
+	mapping = view;
+	length = (size_t)fileSize.QuadPart;
+	return true;
+}
+
+void MappedFile::close() {
+	if (bytes) UnmapViewOfFile(bytes);
+	if (mapping) CloseHandle((HANDLE)mapping);
+	if (file) CloseHandle((HANDLE)file);
+	bytes = nullptr;
+	mapping = file = nullptr;
+	length = 0;
+}
+#else
+bool MappedFile::open(const std::string& path) {
+	close();
+	int descriptor = ::open(path.c_str(), O_RDONLY);
+	if (descriptor < 0) return false;
+	struct stat status;
+	if (fstat(descriptor, &status) != 0 || status.st_size == 0) {
+		::close(descriptor);
+		return false;
+	}
+	void* address = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_SHARED, descriptor, 0);
+	::close(descriptor); // The mapping keeps the file open.
+	if (address == MAP_FAILED) return false;
+	bytes = (const unsigned char*)address;
+	length = (size_t)status.st_size;
+	return true;
+}
+
+void MappedFile::close() {
+	if (bytes) munmap((void*)bytes, length);
+	bytes = nullptr;
+	length = 0;
+}
+#endif
@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// A whole file mapped read-only into memory. Pages are read in from the page cache the first
+// time they are touched, so opening costs next to nothing and every process mapping the same
+// file shares one copy of it.
+class MappedFile {
+public:
+	MappedFile() = default;
+	~MappedFile();
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator =(const MappedFile&) = delete;
+
+	// Unmaps any earlier file first. Returns false if path cannot be opened or is empty.
+	bool open(const std::string& path);
+	void close();
+
+	inline bool isOpen() const { return bytes != nullptr; }
+	inline const unsigned char* data() const { return bytes; }
+	inline size_t size() const { return length; }
+
+private:
+	const unsigned char* bytes = nullptr;
+	size_t length = 0;
+#ifdef _WIN32
+	void* file = nullptr;
+	void* mapping = nullptr;
+#endif
+};
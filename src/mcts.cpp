@@ -0,0 +1,179 @@
+#include "mcts.h"
+#include "playout.h"
+
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+using Clock = std::chrono::high_resolution_clock;
+
+template<int N>
+class MonteCarlo {
+public:
+	MonteCarlo(const Board& board, const SearchLimits& limits, PlayoutKernel kernel) : root(board), limits(limits), kernel(kernel), random((uint64_t)Clock::now().time_since_epoch().count()), start(Clock::now()) {}
+
+	SearchResult run();
+
+private:
+	static constexpr uint8_t PASS = NO_MOVE; // The move of a child that passes.
+
+	// Children of a node are created together and stored next to each other in the arena.
+	struct Node {
+		uint32_t visits = 0;
+		float wins = 0; // For the side that moved into the node, a draw counts half.
+		uint32_t children = 0; // Arena index of the first child, 0 until expanded.
+		uint8_t childCount = 0;
+		uint8_t move = PASS; // The square played to reach the node.
+	};
+
+	Board root;
+	SearchLimits limits;
+	PlayoutKernel kernel;
+	FastRandom random;
+	Clock::time_point start;
+	std::vector<Node> arena;
+	uint64_t playouts = 0;
+	int deepest = 0;
+
+	inline double elapsed() const { return std::chrono::duration<double>(Clock::now() - start).count(); }
+	bool outOfBudget() const;
+
+	void iterate();
+	uint32_t select(const Node& node) const;
+	void expand(uint32_t node, const Board& board);
+
+	static inline Board Apply(const Board& board, uint8_t move) {
+		return move == PASS ? Pass(board) : Play<N>(board, 1ULL << move);
+	}
+};
+
+// The clock and the stop flag are read every 256 playouts.
+template<int N>
+bool MonteCarlo<N>::outOfBudget() const {
+	if (limits.nodes && playouts >= limits.nodes) return true;
+	if ((playouts & 255) != 0) return false;
+	if (limits.seconds > 0 && elapsed() >= limits.seconds) return true;
+	return limits.stop && limits.stop->load(std::memory_order_relaxed);
+}
+
+// The child with the best upper confidence bound, unvisited children first.
+template<int N>
+uint32_t MonteCarlo<N>::select(const Node& node) const {
+	double logVisits = std::log((double)node.visits);
+	uint32_t best = node.children;
+	double bestBound = -1.0;
+	for (uint32_t child = node.children; child < node.children + node.childCount; child++) {
+		const Node& candidate = arena[child];
+		if (!candidate.visits) return child;
+		double bound = candidate.wins / candidate.visits + UCT_EXPLORATION * std::sqrt(logVisits / candidate.visits);
+		if (bound > bestBound) {
+			bestBound = bound;
+			best = child;
+		}
+	}
+	return best;
+}
+
+// Adds a child for every legal move, or a single passing child. The end of the game gets none.
+template<int N>
+void MonteCarlo<N>::expand(uint32_t node, const Board& board) {
+	uint64_t moves = LegalMoves<N>(board);
+	if (!moves && !LegalMoves<N>(Pass(board))) return;
+	uint32_t first = (uint32_t)arena.size();
+	if (first + SquareCount<N>() > MCTS_MAX_NODES) return;
+	if (!moves) {
+		arena.emplace_back();
+	} else {
+		for (; moves; moves &= moves - 1) {
+			arena.emplace_back();
+			arena.back().move = (uint8_t)LowestSquare(moves);
+		}
+	}
+	arena[node].children = first;
+	arena[node].childCount = (uint8_t)(arena.size() - first);
+}
+
+// Selection, expansion, a batch of playouts and backpropagation. A leaf grows its children on its
+// second visit, so nodes that are only ever seen once cost no memory. The leaf plays
+// PLAYOUT_LANES games at once, which the lockstep kernel runs for little more than the cost of one.
+template<int N>
+void MonteCarlo<N>::iterate() {
+	uint32_t path[MaxPly<N>() + 2];
+	int length = 0;
+	uint32_t node = 0;
+	Board board = root;
+	path[length++] = node;
+	while (arena[node].childCount) {
+		node = select(arena[node]);
+		board = Apply(board, arena[node].move);
+		path[length++] = node;
+	}
+	if (arena[node].visits) {
+		expand(node, board);
+		if (arena[node].childCount) {
+			node = arena[node].children;
+			board = Apply(board, arena[node].move);
+			path[length++] = node;
+		}
+	}
+	if (length > deepest) deepest = length;
+	int outcomes[PLAYOUT_LANES];
+	RandomPlayouts<N>(board, PLAYOUT_LANES, random, outcomes, kernel);
+	playouts += PLAYOUT_LANES;
+	float wins = 0; // For the side that moved into the leaf.
+	for (int outcome : outcomes) wins += outcome < 0 ? 1.0f : outcome == 0 ? 0.5f : 0.0f;
+	for (int i = length - 1; i >= 0; i--) {
+		Node& visited = arena[path[i]];
+		visited.visits += PLAYOUT_LANES;
+		visited.wins += wins;
+		wins = PLAYOUT_LANES - wins;
+	}
+}
+
+template<int N>
+SearchResult MonteCarlo<N>::run() {
+	SearchResult result;
+	uint64_t moves = LegalMoves<N>(root);
+	if (PopCount(moves) <= 1) {
+		result.move = moves;
+		return result;
+	}
+	arena.reserve(1 << 16);
+	arena.emplace_back();
+	expand(0, root);
+	do {
+		iterate();
+	} while (!outOfBudget());
+	const Node& rootNode = arena[0];
+	const Node* best = &arena[rootNode.children];
+	for (uint32_t child = rootNode.children; child < rootNode.children + rootNode.childCount; child++) {
+		if (arena[child].visits > best->visits) best = &arena[child];
+	}
+	result.move = 1ULL << best->move;
+	result.score = best->visits ? (int)std::lround(100.0 * best->wins / best->visits) : 0;
+	result.depth = deepest - 1;
+	result.nodes = arena.size();
+	result.playouts = playouts;
+	result.seconds = elapsed();
+	return result;
+}
+
+// The side only matters to searches that share state between the two players, like the minimax
+// player's history table.
+template<int N>
+SearchResult MonteCarloDecision(const Board& board, int /*side*/, const SearchLimits& limits, const SearchOptions& options) {
+	MonteCarlo<N> search(board, limits, options.playouts);
+	return search.run();
+}
+
+SearchResult MonteCarloDecision(const Board& board, int size, int side, const SearchLimits& limits, const SearchOptions& options) {
+	switch (size) {
+		case 6: return MonteCarloDecision<6>(board, side, limits, options);
+		case 8: return MonteCarloDecision<8>(board, side, limits, options);
+		default: return MonteCarloDecision<4>(board, side, limits, options);
+	}
+}
+
+template SearchResult MonteCarloDecision<4>(const Board& board, int side, const SearchLimits& limits, const SearchOptions& options);
+template SearchResult MonteCarloDecision<6>(const Board& board, int side, const SearchLimits& limits, const SearchOptions& options);
+template SearchResult MonteCarloDecision<8>(const Board& board, int side, const SearchLimits& limits, const SearchOptions& options);
@@ -0,0 +1,19 @@
+#pragma once
+#include <cstdint>
+
+#include "bitboard.h"
+#include "search.h"
+
+// Exploration constant of UCT, for rewards between 0 (loss) and 1 (win).
+constexpr double UCT_EXPLORATION = 1.0;
+// Most tree nodes the Monte Carlo player keeps, 16 bytes each. Once full, playouts carry on
+// from the leaves without growing the tree.
+constexpr uint32_t MCTS_MAX_NODES = 1 << 22;
+
+// Picks a move by Monte Carlo tree search (UCT) within limits.seconds, limits.nodes caps the
+// playouts instead. The result's score is the chosen move's win rate in percent, its nodes the
+// size of the tree and playouts the random games played. The same signature as MiniMaxDecision.
+template<int N>
+SearchResult MonteCarloDecision(const Board& board, int side, const SearchLimits& limits, const SearchOptions& options);
+
+SearchResult MonteCarloDecision(const Board& board, int size, int side, const SearchLimits& limits, const SearchOptions& options);
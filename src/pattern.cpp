@@ -0,0 +1,236 @@
+#include "pattern.h"
+#include "playout.h"
+#include "search.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+TernaryTable::TernaryTable() {
+	for (uint32_t bits = 0; bits < 512; bits++) {
+		values[bits] = 0;
+		for (int square = 8; square >= 0; square--) values[bits] = (uint16_t)(3 * values[bits] + ((bits >> square) & 1));
+	}
+}
+
+const TernaryTable Ternary;
+PatternWeights Patterns;
+
+bool ParseEvaluation(const std::string& name, Evaluation& evaluation) {
+	if (name == "discs") evaluation = Evaluation::DISCS;
+	else if (name == "patterns") evaluation = Evaluation::PATTERNS;
+	else return false;
+	return true;
+}
+
+// File layout: WEIGHTS_MAGIC, then the version, the board size and the weights per phase as 32
+// bit numbers, then the weights of every phase.
+static const char WEIGHTS_MAGIC[8] = { 'O', 'T', 'H', 'E', 'V', 'A', 'L', '1' };
+constexpr uint32_t WEIGHTS_VERSION = 1;
+
+static int PhaseSize(int size) {
+	switch (size) {
+		case 6: return PatternLayout<6>::SIZE;
+		case 8: return PatternLayout<8>::SIZE;
+		default: return PatternLayout<4>::SIZE;
+	}
+}
+
+static int PhaseCount(int size) {
+	switch (size) {
+		case 6: return Phases<6>();
+		case 8: return Phases<8>();
+		default: return Phases<4>();
+	}
+}
+
+std::string WeightsFile(int size) {
+	return "othello" + std::to_string(size) + "x" + std::to_string(size) + ".weights";
+}
+
+void PatternWeights::reset(int size) {
+	weights.assign((size_t)PhaseCount(size) * PhaseSize(size), 0);
+	this->size = size;
+}
+
+bool PatternWeights::load(const std::string& path, int size) {
+	std::ifstream in(path, std::ios::binary);
+	char magic[sizeof(WEIGHTS_MAGIC)];
+	uint32_t header[3];
+	if (!in.read(magic, sizeof(magic)) || !in.read((char*)header, sizeof(header)) || std::memcmp(magic, WEIGHTS_MAGIC, sizeof(magic)) != 0
+		|| header[0] != WEIGHTS_VERSION || header[1] != (uint32_t)size || header[2] != (uint32_t)PhaseSize(size)) {
+		return false;
+	}
+	std::vector<int16_t> loaded((size_t)PhaseCount(size) * PhaseSize(size));
+	if (!in.read((char*)loaded.data(), loaded.size() * sizeof(int16_t))) return false;
+	weights.swap(loaded);
+	this->size = size;
+	return true;
+}
+
+bool PatternWeights::save(const std::string& path) const {
+	std::ofstream out(path, std::ios::binary);
+	uint32_t header[3] = { WEIGHTS_VERSION, (uint32_t)size, (uint32_t)PhaseSize(size) };
+	out.write(WEIGHTS_MAGIC, sizeof(WEIGHTS_MAGIC));
+	out.write((const char*)header, sizeof(header));
+	out.write((const char*)weights.data(), weights.size() * sizeof(int16_t));
+	return (bool)out;
+}
+
+// The index of the same squares read in the order the symmetry that maps a pattern onto itself
+// gives them: digit i of index becomes digit order[i].
+static int PermuteDigits(int index, const int* order, int digits) {
+	int permuted = 0;
+	for (int i = 0; i < digits; i++, index /= 3) permuted += (index % 3) * Power3(order[i]);
+	return permuted;
+}
+
+// For every weight the one it has to equal: a pattern and its image under the symmetry that maps
+// its squares onto themselves (an edge or diagonal reversed, a corner transposed) are one shape.
+template<int N>
+static std::vector<int> TiedWeights() {
+	using Layout = PatternLayout<N>;
+	constexpr int W = CornerWidth<N>();
+	int reversed[N], transposed[W * W];
+	for (int i = 0; i < N; i++) reversed[i] = N - 1 - i;
+	for (int i = 0; i < W * W; i++) transposed[i] = (i % W) * W + i / W;
+	std::vector<int> tied(Layout::SIZE);
+	for (int i = 0; i < Power3(N); i++) {
+		tied[Layout::EDGE + i] = Layout::EDGE + PermuteDigits(i, reversed, N);
+		tied[Layout::DIAGONAL + i] = Layout::DIAGONAL + PermuteDigits(i, reversed, N);
+	}
+	for (int i = 0; i < Power3(W * W); i++) tied[Layout::CORNER + i] = Layout::CORNER + PermuteDigits(i, transposed, W * W);
+	tied[Layout::BIAS] = Layout::BIAS;
+	return tied;
+}
+
+struct TrainingPosition {
+	Board board;
+	int side;
+	int score; // Of the search that labelled it.
+};
+
+// Phase by phase from the end of the game: a position is labelled with a search that reaches
+// the end of the phase after it, whose weights are already fitted, or the end of the game in
+// the last phase. The weights of the phase are then fitted to the labels by least squares.
+template<int N>
+static int Train(int games, int epochs, const std::string& path) {
+	using Layout = PatternLayout<N>;
+	auto start = std::chrono::steady_clock::now();
+	std::vector<std::vector<TrainingPosition>> phases(Phases<N>());
+	FastRandom random(20211017);
+	for (int game = 0; game < games; game++) {
+		Board board = StartingBoard(N);
+		int side = 0;
+		for (;;) {
+			uint64_t moves = LegalMoves<N>(board);
+			if (!moves) {
+				board = Pass(board);
+				side ^= 1;
+				if (!LegalMoves<N>(board)) break;
+				continue;
+			}
+			if (PopCount(moves) > 1) phases[(Empties<N>(board) - 1) / PhaseEmpties<N>()].push_back({ board, side, 0 });
+			board = Play<N>(board, RandomSquare(moves, random));
+			side ^= 1;
+		}
+	}
+
+	std::vector<int> tied = TiedWeights<N>();
+	Patterns.reset(N);
+	SearchLimits limits;
+	limits.seconds = 0;
+	SearchOptions options;
+	options.evaluation = Evaluation::PATTERNS;
+	for (int phase = 0; phase < Phases<N>(); phase++) {
+		std::vector<TrainingPosition>& positions = phases[phase];
+		TransTable.clear(); // Scores of earlier phases used weights that have changed since.
+		double discError = 0;
+		for (TrainingPosition& position : positions) {
+			limits.depth = Empties<N>(position.board) - phase * PhaseEmpties<N>();
+			position.score = MiniMaxDecision<N>(position.board, position.side, limits, options).score;
+			double error = position.score - DiscDifference(position.board);
+			discError += error * error;
+		}
+
+		// Each weight moves by the mean error of the positions using it, divided by the number of
+		// weights every position sums so they do not all correct the same error at once.
+		std::vector<double> weights(Layout::SIZE, 0.0), errors(Layout::SIZE), counts(Layout::SIZE);
+		double rate = 1.0 / (PATTERN_COUNT + 1), error = 0;
+		for (int epoch = 0; epoch <= epochs; epoch++) {
+			std::fill(errors.begin(), errors.end(), 0.0);
+			std::fill(counts.begin(), counts.end(), 0.0);
+			error = 0;
+			for (const TrainingPosition& position : positions) {
+				PatternIndices patterns;
+				GetPatternIndices<N>(position.board, patterns);
+				double residual = position.score - weights[Layout::BIAS];
+				for (int index : patterns.indices) residual -= weights[index];
+				error += residual * residual;
+				errors[Layout::BIAS] += residual;
+				counts[Layout::BIAS]++;
+				for (int index : patterns.indices) {
+					int weight = std::min(index, tied[index]);
+					errors[weight] += residual;
+					counts[weight]++;
+				}
+			}
+			if (epoch == epochs) break; // The last pass only measures.
+			for (int weight = 0; weight < Layout::SIZE; weight++) {
+				if (!counts[weight]) continue;
+				// A few phantom positions with no error keep rarely seen shapes close to zero.
+				weights[weight] += rate * errors[weight] / (counts[weight] + 4);
+				weights[tied[weight]] = weights[weight];
+			}
+		}
+
+		int16_t* table = Patterns.phase(phase, Layout::SIZE);
+		for (int weight = 0; weight < Layout::SIZE; weight++) {
+			table[weight] = (int16_t)std::max(-32767.0, std::min(32767.0, std::round(weights[weight] * EVAL_SCALE)));
+		}
+		double count = positions.empty() ? 1.0 : (double)positions.size();
+		std::cout << "Phase " << phase << " (" << phase * PhaseEmpties<N>() + 1 << "-" << (phase + 1) * PhaseEmpties<N>() << " empties): "
+			<< positions.size() << " positions, error " << std::sqrt(error / count) << " discs against "
+			<< std::sqrt(discError / count) << " for the disc count." << std::endl;
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	if (!Patterns.save(path)) {
+		std::cerr << "Could not write " << path << "." << std::endl;
+		return 1;
+	}
+	std::cout << "Trained in " << seconds << "s. Wrote " << path << "." << std::endl;
+	return 0;
+}
+
+int RunTrainer(int argc, char** args) {
+	int size = 8;
+	int games = 4000;
+	int epochs = 40;
+	std::string path;
+	for (int i = 2; i < argc; i++) {
+		std::string option = args[i];
+		if (option == "--size" && i + 1 < argc) size = std::atoi(args[++i]);
+		else if (option == "--games" && i + 1 < argc) games = std::atoi(args[++i]);
+		else if (option == "--epochs" && i + 1 < argc) epochs = std::atoi(args[++i]);
+		else if (option == "--out" && i + 1 < argc) path = args[++i];
+		else {
+			std::cerr << "Usage: " << args[0] << " train [--size 6|8] [--games <count>] [--epochs <count>] [--out <file>]" << std::endl;
+			return 2;
+		}
+	}
+	if (size != 6 && size != 8) {
+		std::cerr << "Invalid board size: " << size << ".\n    Weights are trained for: 6 and 8, 4x4 is solved outright." << std::endl;
+		return 2;
+	}
+	if (games <= 0 || epochs < 0) {
+		std::cerr << "Invalid training settings: the games are one or more and the epochs zero or more." << std::endl;
+		return 2;
+	}
+	if (path.empty()) path = WeightsFile(size);
+	return size == 6 ? Train<6>(games, epochs, path) : Train<8>(games, epochs, path);
+}
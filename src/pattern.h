@@ -0,0 +1,209 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "bitboard.h"
+#include "symmetry.h"
+
+// Pattern evaluation: the depth limited search's estimate of the final disc difference, for
+// positions the search cannot take to the end of the game.
+//
+// A pattern is a fixed set of squares: an edge, the block of squares in a corner or a main
+// diagonal. Each square is empty, the side to move's or the opponent's, so the contents of a
+// pattern read as a ternary number, which indexes a flat table of weights. The evaluation sums
+// the weights of every pattern on the board, each place of a pattern read with its squares in
+// the order the symmetry that maps it onto the first place gives them, so the four edges share
+// one table, as do the four corners and the two diagonals.
+// The game is split into phases of a few empties each, with a table of every pattern per phase.
+//
+// Weights are in 1/EVAL_SCALE discs, fitted by `othello train` and loaded from a file.
+constexpr int EVAL_SCALE = 64;
+
+enum class Evaluation { DISCS, PATTERNS };
+
+// Reads "discs" or "patterns", as given on the command line.
+bool ParseEvaluation(const std::string& name, Evaluation& evaluation);
+
+// The corner block is 3x3, 2x2 on the 4x4 board where 3x3 would reach past the centre.
+template<int N>
+constexpr int CornerWidth() {
+	return N > 4 ? 3 : 2;
+}
+
+// Empties per phase, the phase of a position is (empties - 1) / PhaseEmpties.
+template<int N>
+constexpr int PhaseEmpties() {
+	return N - 2;
+}
+
+template<int N>
+constexpr int Phases() {
+	return (SquareCount<N>() - 4 + PhaseEmpties<N>() - 1) / PhaseEmpties<N>();
+}
+
+constexpr int Power3(int exponent) {
+	return exponent ? 3 * Power3(exponent - 1) : 1;
+}
+
+// Offsets of each pattern's table within a phase, which ends with one weight for the phase itself.
+template<int N>
+struct PatternLayout {
+	static constexpr int EDGE = 0;
+	static constexpr int CORNER = EDGE + Power3(N);
+	static constexpr int DIAGONAL = CORNER + Power3(CornerWidth<N>() * CornerWidth<N>());
+	static constexpr int BIAS = DIAGONAL + Power3(N);
+	static constexpr int SIZE = BIAS + 1;
+};
+
+// Bits read as a base 3 number whose digits are all 0 or 1, for patterns of up to nine squares.
+struct TernaryTable {
+	uint16_t values[512];
+
+	TernaryTable();
+};
+
+extern const TernaryTable Ternary;
+
+// The player's squares are the digit 1 and the opponent's 2.
+inline int PatternIndex(uint32_t player, uint32_t opponent) {
+	return Ternary.values[player] + 2 * Ternary.values[opponent];
+}
+
+// The bit extractors below read a place of a pattern straight off the board, its squares gathered
+// into the low bits, digit by digit, rather than transforming the whole board onto the first place.
+
+// The squares (0, 0) to (0, N - 1) of the first column.
+template<int N>
+inline uint32_t EdgeBits(uint64_t bits) {
+	return (uint32_t)(bits & ((1ULL << N) - 1));
+}
+
+// Shifts of 0, N - 1, 2 (N - 1)... which move square (x, 0) to bit (N - 1)^2 + x: multiplying
+// the first row by them lines it up there without two squares landing on the same bit.
+template<int N>
+constexpr uint64_t RowStride(int x = 0) {
+	return x == N ? 0 : (1ULL << (x * (N - 1))) | RowStride<N>(x + 1);
+}
+
+// The squares (0, 0) to (N - 1, 0) of the first row.
+template<int N>
+inline uint32_t RowBits(uint64_t bits) {
+	return (uint32_t)((((bits & RowMask<N>(0)) * RowStride<N>()) >> ((N - 1) * (N - 1))) & ((1ULL << N) - 1));
+}
+
+// Reverses the order of the W squares within each column of a corner block.
+template<int W>
+inline uint32_t ReverseColumns(uint32_t corner) {
+	constexpr uint32_t FIRST = W > 2 ? 0x49 : 0x5; // The first square of every column.
+	return W > 2 ? ((corner & FIRST) << 2) | (corner & (FIRST << 1)) | ((corner >> 2) & FIRST) : ((corner & FIRST) << 1) | ((corner >> 1) & FIRST);
+}
+
+// The first square of column x of a corner block, counted from the near or the far side in x.
+template<int N, bool FAR_X, bool FAR_Y>
+constexpr int CornerColumn(int x) {
+	return (FAR_X ? N - 1 - x : x) * N + (FAR_Y ? N - CornerWidth<N>() : 0);
+}
+
+// The corner block nearest (0, 0), or the one on the far side of x or y: digit x * W + y is the
+// square x columns and y rows in from the corner. Written out column by column so every shift
+// is a constant.
+template<int N, bool FAR_X = false, bool FAR_Y = false>
+inline uint32_t CornerBits(uint64_t bits) {
+	constexpr int W = CornerWidth<N>();
+	constexpr uint64_t COLUMN = (1u << W) - 1;
+	uint32_t corner = (uint32_t)((bits >> CornerColumn<N, FAR_X, FAR_Y>(0)) & COLUMN)
+		| (uint32_t)((bits >> CornerColumn<N, FAR_X, FAR_Y>(1)) & COLUMN) << W;
+	if (W > 2) corner |= (uint32_t)((bits >> CornerColumn<N, FAR_X, FAR_Y>(W - 1)) & COLUMN) << (2 * W);
+	return FAR_Y ? ReverseColumns<W>(corner) : corner;
+}
+
+// One bit every N squares, so multiplying a diagonal by it stacks every diagonal square into
+// the last column without two landing on the same bit.
+template<int N>
+constexpr uint64_t ColumnStride(int x = 0) {
+	return x == N ? 0 : (1ULL << (x * N)) | ColumnStride<N>(x + 1);
+}
+
+// The squares (N - 1 - x, x), the main diagonal mirrored in x.
+template<int N>
+constexpr uint64_t AntiDiagonalMask(int x = 0) {
+	return x == N ? 0 : (1ULL << ((N - 1 - x) * N + x)) | AntiDiagonalMask<N>(x + 1);
+}
+
+// Square (x, x) of the diagonal, or (N - 1 - x, x) of the anti-diagonal, becomes digit x.
+template<int N>
+inline uint32_t DiagonalBits(uint64_t bits, uint64_t mask = DiagonalMask<N>(0)) {
+	return (uint32_t)((((bits & mask) * ColumnStride<N>()) >> ((N - 1) * N)) & ((1ULL << N) - 1));
+}
+
+// Four edges, four corners and two diagonals.
+constexpr int PATTERN_COUNT = 10;
+
+// Every pattern of a position, as indices into the tables of its phase.
+struct PatternIndices {
+	int phase;
+	int indices[PATTERN_COUNT];
+};
+
+template<int N>
+inline void GetPatternIndices(const Board& board, PatternIndices& patterns) {
+	using Layout = PatternLayout<N>;
+	int empties = SquareCount<N>() - PopCount(board.player | board.opponent);
+	patterns.phase = empties > 0 ? (empties - 1) / PhaseEmpties<N>() : 0;
+	constexpr int FAR = (N - 1) * N; // The first square of the last column.
+	int* index = patterns.indices;
+	index[0] = Layout::EDGE + PatternIndex(EdgeBits<N>(board.player), EdgeBits<N>(board.opponent));
+	index[1] = Layout::EDGE + PatternIndex(EdgeBits<N>(board.player >> FAR), EdgeBits<N>(board.opponent >> FAR));
+	index[2] = Layout::EDGE + PatternIndex(RowBits<N>(board.player), RowBits<N>(board.opponent));
+	index[3] = Layout::EDGE + PatternIndex(RowBits<N>(board.player >> (N - 1)), RowBits<N>(board.opponent >> (N - 1)));
+	// The corner at (0, N - 1) is read transposed, which the tied weights of a corner do not tell apart.
+	index[4] = Layout::CORNER + PatternIndex(CornerBits<N>(board.player), CornerBits<N>(board.opponent));
+	index[5] = Layout::CORNER + PatternIndex(CornerBits<N, true, false>(board.player), CornerBits<N, true, false>(board.opponent));
+	index[6] = Layout::CORNER + PatternIndex(CornerBits<N, false, true>(board.player), CornerBits<N, false, true>(board.opponent));
+	index[7] = Layout::CORNER + PatternIndex(CornerBits<N, true, true>(board.player), CornerBits<N, true, true>(board.opponent));
+	index[8] = Layout::DIAGONAL + PatternIndex(DiagonalBits<N>(board.player), DiagonalBits<N>(board.opponent));
+	index[9] = Layout::DIAGONAL + PatternIndex(DiagonalBits<N>(board.player, AntiDiagonalMask<N>()), DiagonalBits<N>(board.opponent, AntiDiagonalMask<N>()));
+}
+
+// The weight tables of one board size, every phase one after the other.
+class PatternWeights {
+public:
+	// Reads the file at path, false if it is missing or holds weights for another board size.
+	bool load(const std::string& path, int size);
+	bool save(const std::string& path) const;
+	// Zeroed tables for size, for the trainer to fill.
+	void reset(int size);
+
+	inline int getSize() const { return size; }
+	inline int16_t* phase(int phase, int phaseSize) { return weights.data() + (size_t)phase * phaseSize; }
+
+	template<int N>
+	inline int evaluate(const Board& board) const;
+
+private:
+	std::vector<int16_t> weights;
+	int size = 0;
+};
+
+// The side to move's expected final disc difference, rounded to whole discs like every score.
+template<int N>
+inline int PatternWeights::evaluate(const Board& board) const {
+	using Layout = PatternLayout<N>;
+	PatternIndices patterns;
+	GetPatternIndices<N>(board, patterns);
+	const int16_t* table = weights.data() + (size_t)patterns.phase * Layout::SIZE;
+	int sum = table[Layout::BIAS];
+	for (int index : patterns.indices) sum += table[index];
+	return (sum + (sum >= 0 ? EVAL_SCALE / 2 : -EVAL_SCALE / 2)) / EVAL_SCALE;
+}
+
+// Where the game and the trainer look for the weights of a board size by default.
+std::string WeightsFile(int size);
+
+// Loaded by the game, used by the search when SearchOptions::evaluation asks for patterns.
+extern PatternWeights Patterns;
+
+// Fits the weights from random games and writes them, run as:
+// othello train [--size 6|8] [--games <count>] [--epochs <count>] [--out <file>]
+int RunTrainer(int argc, char** args);
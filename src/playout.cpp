@@ -0,0 +1,217 @@
+#include "playout.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define PLAYOUT_AVX2 1
+// Only the kernel is compiled for AVX2, the rest of the program still runs anywhere.
+#define AVX2_TARGET __attribute__((target("avx2")))
+#elif defined(_MSC_VER) && defined(_M_X64)
+#include <immintrin.h>
+#include <intrin.h>
+#define PLAYOUT_AVX2 1
+#define AVX2_TARGET
+#else
+#define PLAYOUT_AVX2 0
+#endif
+
+PlayoutKernel BestPlayoutKernel() {
+#if PLAYOUT_AVX2 && defined(_MSC_VER)
+	static const PlayoutKernel best = []() {
+		int info[4];
+		__cpuidex(info, 7, 0);
+		bool avx2 = (info[1] & (1 << 5)) != 0;
+		__cpuid(info, 1);
+		bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+		return avx2 && osSavesYmm ? PlayoutKernel::AVX2 : PlayoutKernel::SCALAR;
+	}();
+	return best;
+#elif PLAYOUT_AVX2
+	static const PlayoutKernel best = __builtin_cpu_supports("avx2") ? PlayoutKernel::AVX2 : PlayoutKernel::SCALAR;
+	return best;
+#else
+	return PlayoutKernel::SCALAR;
+#endif
+}
+
+bool ParsePlayoutKernel(const std::string& name, PlayoutKernel& kernel) {
+	if (name == "scalar") kernel = PlayoutKernel::SCALAR;
+	else if (name == "avx2") kernel = PlayoutKernel::AVX2;
+	else return false;
+	return true;
+}
+
+// The boards of every lane. moves holds each lane's legal moves, then the move it plays.
+// A lane playing move 0 passes: it has no flips, so the play step only swaps the sides.
+struct Lanes {
+	alignas(32) uint64_t player[PLAYOUT_LANES];
+	alignas(32) uint64_t opponent[PLAYOUT_LANES];
+	alignas(32) uint64_t moves[PLAYOUT_LANES];
+};
+
+template<int N>
+struct ScalarKernel {
+	static void legalMoves(Lanes& lanes) {
+		for (int i = 0; i < PLAYOUT_LANES; i++) lanes.moves[i] = LegalMoves<N>(Board(lanes.player[i], lanes.opponent[i]));
+	}
+
+	static void play(Lanes& lanes) {
+		for (int i = 0; i < PLAYOUT_LANES; i++) {
+			uint64_t player = lanes.player[i], opponent = lanes.opponent[i], move = lanes.moves[i];
+			uint64_t flips = Flips<N>(Board(player, opponent), move);
+			lanes.player[i] = opponent ^ flips;
+			lanes.opponent[i] = player ^ flips ^ move;
+		}
+	}
+};
+
+#if PLAYOUT_AVX2
+// The bitboard kernels of bitboard.h, four boards per register.
+template<int Step>
+AVX2_TARGET inline __m256i ShiftLanes(__m256i bits) {
+	return Step > 0 ? _mm256_slli_epi64(bits, Step > 0 ? Step : 0) : _mm256_srli_epi64(bits, Step < 0 ? -Step : 0);
+}
+
+template<int N, int Step, uint64_t Mask>
+AVX2_TARGET inline __m256i FillLanes(__m256i gen, __m256i pro) {
+	pro = _mm256_and_si256(pro, _mm256_set1_epi64x((long long)Mask));
+	gen = _mm256_or_si256(gen, _mm256_and_si256(pro, ShiftLanes<Step>(gen)));
+	pro = _mm256_and_si256(pro, ShiftLanes<Step>(pro));
+	gen = _mm256_or_si256(gen, _mm256_and_si256(pro, ShiftLanes<2 * Step>(gen)));
+	if (N > 5) {
+		pro = _mm256_and_si256(pro, ShiftLanes<2 * Step>(pro));
+		gen = _mm256_or_si256(gen, _mm256_and_si256(pro, ShiftLanes<4 * Step>(gen)));
+	}
+	return gen;
+}
+
+template<int N, int DX, int DY>
+AVX2_TARGET inline __m256i DirectionMovesLanes(__m256i player, __m256i opponent) {
+	constexpr int step = DX * N + DY;
+	constexpr uint64_t mask = LandingMask<N>(DY);
+	__m256i run = _mm256_and_si256(FillLanes<N, step, mask>(player, opponent), opponent);
+	return _mm256_and_si256(ShiftLanes<step>(run), _mm256_set1_epi64x((long long)mask));
+}
+
+template<int N, int DX, int DY>
+AVX2_TARGET inline __m256i DirectionFlipsLanes(__m256i move, __m256i player, __m256i opponent) {
+	constexpr int step = DX * N + DY;
+	constexpr uint64_t mask = LandingMask<N>(DY);
+	__m256i run = _mm256_and_si256(FillLanes<N, step, mask>(move, opponent), opponent);
+	__m256i bracketed = _mm256_and_si256(_mm256_and_si256(ShiftLanes<step>(_mm256_or_si256(run, move)), _mm256_set1_epi64x((long long)mask)), player);
+	return _mm256_andnot_si256(_mm256_cmpeq_epi64(bracketed, _mm256_setzero_si256()), run);
+}
+
+template<int N>
+struct AVX2Kernel {
+	AVX2_TARGET static void legalMoves(Lanes& lanes) {
+		for (int i = 0; i < PLAYOUT_LANES; i += 4) {
+			__m256i p = _mm256_load_si256((const __m256i*)(lanes.player + i));
+			__m256i o = _mm256_load_si256((const __m256i*)(lanes.opponent + i));
+			__m256i moves = _mm256_or_si256(
+				_mm256_or_si256(_mm256_or_si256(DirectionMovesLanes<N, 0, 1>(p, o), DirectionMovesLanes<N, 0, -1>(p, o)),
+					_mm256_or_si256(DirectionMovesLanes<N, 1, 0>(p, o), DirectionMovesLanes<N, -1, 0>(p, o))),
+				_mm256_or_si256(_mm256_or_si256(DirectionMovesLanes<N, 1, 1>(p, o), DirectionMovesLanes<N, -1, -1>(p, o)),
+					_mm256_or_si256(DirectionMovesLanes<N, 1, -1>(p, o), DirectionMovesLanes<N, -1, 1>(p, o))));
+			_mm256_store_si256((__m256i*)(lanes.moves + i), _mm256_andnot_si256(_mm256_or_si256(p, o), moves));
+		}
+	}
+
+	AVX2_TARGET static void play(Lanes& lanes) {
+		for (int i = 0; i < PLAYOUT_LANES; i += 4) {
+			__m256i p = _mm256_load_si256((const __m256i*)(lanes.player + i));
+			__m256i o = _mm256_load_si256((const __m256i*)(lanes.opponent + i));
+			__m256i m = _mm256_load_si256((const __m256i*)(lanes.moves + i));
+			__m256i flips = _mm256_or_si256(
+				_mm256_or_si256(_mm256_or_si256(DirectionFlipsLanes<N, 0, 1>(m, p, o), DirectionFlipsLanes<N, 0, -1>(m, p, o)),
+					_mm256_or_si256(DirectionFlipsLanes<N, 1, 0>(m, p, o), DirectionFlipsLanes<N, -1, 0>(m, p, o))),
+				_mm256_or_si256(_mm256_or_si256(DirectionFlipsLanes<N, 1, 1>(m, p, o), DirectionFlipsLanes<N, -1, -1>(m, p, o)),
+					_mm256_or_si256(DirectionFlipsLanes<N, 1, -1>(m, p, o), DirectionFlipsLanes<N, -1, 1>(m, p, o))));
+			_mm256_store_si256((__m256i*)(lanes.player + i), _mm256_xor_si256(o, flips));
+			_mm256_store_si256((__m256i*)(lanes.opponent + i), _mm256_xor_si256(_mm256_xor_si256(p, flips), m));
+		}
+	}
+};
+#endif
+
+// The lockstep loop: the kernel finds every lane's legal moves, each lane picks one at random
+// or passes, and the kernel plays them all. A lane whose game ended reports it and restarts
+// from board while games are left to start.
+template<int N, class Kernel>
+void Lockstep(const Board& board, int count, FastRandom& random, int* outcomes) {
+	Board start = board;
+	int startSign = 1; // Turns disc differences on a lane's board into ones for board's side to move.
+	if (!LegalMoves<N>(start)) {
+		if (!LegalMoves<N>(Pass(start))) {
+			for (int i = 0; i < count; i++) outcomes[i] = PopCount(board.player) - PopCount(board.opponent);
+			return;
+		}
+		start = Pass(start);
+		startSign = -1;
+	}
+	uint64_t startMoves = LegalMoves<N>(start);
+	Lanes lanes;
+	int sign[PLAYOUT_LANES];
+	bool passed[PLAYOUT_LANES], active[PLAYOUT_LANES];
+	int started = 0, finished = 0;
+	for (int lane = 0; lane < PLAYOUT_LANES; lane++) {
+		lanes.player[lane] = start.player;
+		lanes.opponent[lane] = start.opponent;
+		sign[lane] = startSign;
+		passed[lane] = false;
+		active[lane] = started < count;
+		if (active[lane]) started++;
+	}
+	while (finished < count) {
+		Kernel::legalMoves(lanes);
+		for (int lane = 0; lane < PLAYOUT_LANES; lane++) {
+			uint64_t moves = lanes.moves[lane];
+			if (!active[lane]) {
+				lanes.moves[lane] = 0;
+				continue;
+			}
+			if (!moves) {
+				if (!passed[lane]) {
+					passed[lane] = true;
+					continue;
+				}
+				outcomes[finished++] = sign[lane] * (PopCount(lanes.player[lane]) - PopCount(lanes.opponent[lane]));
+				if (started == count) {
+					active[lane] = false;
+					continue;
+				}
+				started++;
+				lanes.player[lane] = start.player;
+				lanes.opponent[lane] = start.opponent;
+				sign[lane] = startSign;
+				moves = startMoves;
+			}
+			passed[lane] = false;
+			lanes.moves[lane] = RandomSquare(moves, random);
+		}
+		Kernel::play(lanes);
+		for (int lane = 0; lane < PLAYOUT_LANES; lane++) sign[lane] = -sign[lane];
+	}
+}
+
+template<int N>
+void RandomPlayouts(const Board& board, int count, FastRandom& random, int* outcomes, PlayoutKernel kernel) {
+#if PLAYOUT_AVX2
+	if (kernel == PlayoutKernel::AVX2 && BestPlayoutKernel() == PlayoutKernel::AVX2) {
+		Lockstep<N, AVX2Kernel<N>>(board, count, random, outcomes);
+		return;
+	}
+#endif
+	Lockstep<N, ScalarKernel<N>>(board, count, random, outcomes);
+}
+
+void RandomPlayouts(const Board& board, int size, int count, FastRandom& random, int* outcomes, PlayoutKernel kernel) {
+	switch (size) {
+		case 6: RandomPlayouts<6>(board, count, random, outcomes, kernel); break;
+		case 8: RandomPlayouts<8>(board, count, random, outcomes, kernel); break;
+		default: RandomPlayouts<4>(board, count, random, outcomes, kernel); break;
+	}
+}
+
+template void RandomPlayouts<4>(const Board& board, int count, FastRandom& random, int* outcomes, PlayoutKernel kernel);
+template void RandomPlayouts<6>(const Board& board, int count, FastRandom& random, int* outcomes, PlayoutKernel kernel);
+template void RandomPlayouts<8>(const Board& board, int count, FastRandom& random, int* outcomes, PlayoutKernel kernel);
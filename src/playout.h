@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+#include "bitboard.h"
+
+// xorshift64*, a few cycles per number, which is all a random playout needs.
+class FastRandom {
+public:
+	explicit FastRandom(uint64_t seed) : state(seed ? seed : 0x9E3779B97F4A7C15ULL) {}
+
+	inline uint64_t next() {
+		state ^= state >> 12;
+		state ^= state << 25;
+		state ^= state >> 27;
+		return state * 0x2545F4914F6CDD1DULL;
+	}
+
+	// Uniform in [0, bound), bound at most 64.
+	inline int below(int bound) {
+		return (int)(((next() >> 32) * (uint64_t)bound) >> 32);
+	}
+
+private:
+	uint64_t state;
+};
+
+// One of the set bits of squares, chosen uniformly.
+inline uint64_t RandomSquare(uint64_t squares, FastRandom& random) {
+	for (int skip = random.below(PopCount(squares)); skip > 0; skip--) squares &= squares - 1;
+	return squares & (0 - squares);
+}
+
+// Random games advanced together, one per lane, two AVX2 registers of four boards each.
+constexpr int PLAYOUT_LANES = 8;
+
+// How the lanes compute legal moves and flips: one board at a time, or four per AVX2 instruction.
+enum class PlayoutKernel { SCALAR, AVX2 };
+
+// AVX2 when the build targets x86-64 and the processor running it has it.
+PlayoutKernel BestPlayoutKernel();
+// Reads "scalar" or "avx2".
+bool ParsePlayoutKernel(const std::string& name, PlayoutKernel& kernel);
+
+// Plays count random games from board to the end, PLAYOUT_LANES at a time in lockstep. outcomes
+// gets the final disc difference of each game for the side to move on board, in the order the
+// games finish. A lane that finishes early starts the next game rather than waiting for the others.
+template<int N>
+void RandomPlayouts(const Board& board, int count, FastRandom& random, int* outcomes, PlayoutKernel kernel);
+
+void RandomPlayouts(const Board& board, int size, int count, FastRandom& random, int* outcomes, PlayoutKernel kernel);
@@ -552,15 +552,15 @@ void RendererInit() {
 	RenderShaderProgram->uploadInt("font", 4);
 }
 
-void RenderQuad(const glm::vec2& position, Textures texture, float transparency) {
+void RenderQuad(const glm::vec2& position, Textures texture, float transparency, float size) {
 	if (QuadCount >= QUAD_COUNT) {
 		RendererFlush();
 	}
 	const Vertex vertices[4] = {
-		{ (position + glm::vec2{  0.f,  0.f }) * 64.0f, {0.0f, 0.0f}, (uint32_t)texture, transparency},
-		{ (position + glm::vec2{  0.f, -1.f }) * 64.0f, {0.0f, 1.0f}, (uint32_t) texture, transparency },
-		{ (position + glm::vec2{  1.f, -1.f }) * 64.0f, {1.0f, 1.0f}, (uint32_t) texture, transparency },
-		{ (position + glm::vec2{  1.f,  0.f }) * 64.0f, {1.0f, 0.0f}, (uint32_t) texture, transparency }
+		{ (position + glm::vec2{  0.f,  0.f }) * size, {0.0f, 0.0f}, (uint32_t)texture, transparency},
+		{ (position + glm::vec2{  0.f, -1.f }) * size, {0.0f, 1.0f}, (uint32_t) texture, transparency },
+		{ (position + glm::vec2{  1.f, -1.f }) * size, {1.0f, 1.0f}, (uint32_t) texture, transparency },
+		{ (position + glm::vec2{  1.f,  0.f }) * size, {1.0f, 0.0f}, (uint32_t) texture, transparency }
 	};
 
 	Vertices[QuadCount++] = vertices[0];
@@ -176,7 +176,7 @@ enum class Textures { LIGHT_PIECE, DARK_PIECE, LIGHT_BOARD, DARK_BOARD };
 
 void RendererInit();
 
-void RenderQuad(const glm::vec2& position, Textures texture, float transparency = 1.0f);
+void RenderQuad(const glm::vec2& position, Textures texture, float transparency = 1.0f, float size = 64.0f);
 void RenderText(const std::string& text, const glm::vec2& position);
 void RendererFlush();
 
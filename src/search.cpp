@@ -0,0 +1,997 @@
+#include "search.h"
+#include "book.h"
+#include "solved.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::high_resolution_clock;
+
+TranspositionTable TransTable(DEFAULT_HASH_MEGABYTES);
+
+// Nodes this close to the end are cheaper to search again than to look up.
+constexpr int TT_MIN_DEPTH = 4;
+// Once the root is within SearchOptions::solveEmpties of the end, deepening jumps to solving the
+// game as soon as it has an answer from SOLVE_AFTER_DEPTH plies: the solver is far faster than
+// the depths in between.
+constexpr int SOLVE_AFTER_DEPTH = 4;
+// The endgame solver probes the children of nodes with this many empties for a cutoff.
+constexpr int ETC_EMPTIES = 10;
+
+inline int NextDepth(int depth, int rootEmpties, int solveEmpties, int maxDepth) {
+	if (rootEmpties > solveEmpties || depth < SOLVE_AFTER_DEPTH) return depth + 1;
+	return std::max(depth + 1, std::min(rootEmpties, maxDepth));
+}
+
+// Half width of the first aspiration window, in discs.
+constexpr int ASPIRATION_WINDOW = 4;
+// YBWC only splits nodes with enough work left to pay for handing it to another thread.
+constexpr int SPLIT_MIN_DEPTH = 4;
+constexpr int SPLIT_MIN_EMPTIES = 10; // The same for the endgame solver, whose nodes are cheaper.
+
+inline bool TTCutoff(const TTEntry& entry, int alpha, int beta) {
+	return entry.bound == Bound::EXACT || (entry.bound == Bound::LOWER && entry.score >= beta) || (entry.bound == Bound::UPPER && entry.score <= alpha);
+}
+
+inline Bound BoundFor(int score, int alpha, int beta) {
+	return score <= alpha ? Bound::UPPER : score >= beta ? Bound::LOWER : Bound::EXACT;
+}
+
+int HardwareThreads() {
+	unsigned threads = std::thread::hardware_concurrency();
+	return threads ? (int)threads : 1;
+}
+
+bool ParseSearchAlgorithm(const std::string& name, SearchAlgorithm& algorithm) {
+	if (name == "alphabeta") algorithm = SearchAlgorithm::ALPHA_BETA;
+	else if (name == "pvs") algorithm = SearchAlgorithm::PVS;
+	else return false;
+	return true;
+}
+
+bool ParseParallelSearch(const std::string& name, ParallelSearch& parallel) {
+	if (name == "rootsplit") parallel = ParallelSearch::ROOT_SPLIT;
+	else if (name == "lazysmp") parallel = ParallelSearch::LAZY_SMP;
+	else if (name == "ybwc") parallel = ParallelSearch::YBWC;
+	else return false;
+	return true;
+}
+
+bool ParseSearchDriver(const std::string& name, SearchDriver& driver) {
+	if (name == "full") driver = SearchDriver::FULL_WINDOW;
+	else if (name == "aspiration") driver = SearchDriver::ASPIRATION;
+	else if (name == "mtdf") driver = SearchDriver::MTDF;
+	else return false;
+	return true;
+}
+
+bool ParseOrdering(const std::string& list, uint32_t& flags) {
+	flags = 0;
+	size_t begin = 0;
+	while (begin <= list.size()) {
+		size_t end = list.find(',', begin);
+		if (end == std::string::npos) end = list.size();
+		std::string name = list.substr(begin, end - begin);
+		if (name == "tt") flags |= ORDER_TT;
+		else if (name == "killers") flags |= ORDER_KILLERS;
+		else if (name == "history") flags |= ORDER_HISTORY;
+		else if (name == "squares") flags |= ORDER_SQUARES;
+		else if (name != "none") return false;
+		begin = end + 1;
+	}
+	return true;
+}
+
+// Budget the threads of one parallel search draw from together.
+struct SharedBudget {
+	std::atomic<uint64_t> nodes{ 0 };
+	std::atomic<bool> stop{ false }; // Set by the first thread to run out, read by the rest.
+};
+
+template<int N>
+class RootSplit;
+template<int N>
+class WorkStealing;
+
+// A YBWC node whose younger brothers are being searched by several threads. It lives on the
+// stack of the thread that split it, which waits until every brother has been taken care of.
+// A node of the endgame solver splits with depth set to its empties, so its brothers go straight
+// to the solver.
+template<int N>
+struct SplitPoint {
+	Board board; // The node, for threads that take a brother.
+	int side;
+	int ply;
+	int depth;
+	int beta;
+	SplitPoint* parent; // The split point the node itself is searched under, if any.
+
+	std::mutex mutex; // Guards best and bestSquare.
+	std::condition_variable finished; // Signalled as each brother finishes.
+	int best;
+	uint8_t bestSquare;
+	std::atomic<int> alpha;
+	std::atomic<bool> aborted{ false }; // A brother failed high, the rest are no longer needed.
+	std::atomic<int> pending; // Brothers not yet searched or skipped.
+	std::atomic<uint64_t> horizonHits{ 0 };
+
+	inline void update(int value, uint8_t square) {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (value > best) {
+			best = value;
+			bestSquare = square;
+			if (value > alpha) alpha = value;
+			if (value >= beta) aborted = true;
+		}
+	}
+};
+
+template<int N>
+class Searcher {
+public:
+	Searcher(const Board& board, int side, const SearchLimits& limits, const SearchOptions& options, SharedBudget* shared = nullptr)
+		: position(board, side), limits(limits), options(options), orderer(options.ordering), start(Clock::now()), shared(shared),
+		patterns(options.evaluation == Evaluation::PATTERNS && Patterns.getSize() == N) {}
+
+	// firstDepth lets helper threads start their iterative deepening deeper than the main thread.
+	SearchResult run(int firstDepth = 1);
+
+private:
+	friend class RootSplit<N>;
+	friend class WorkStealing<N>;
+
+	Position<N> position;
+	SearchLimits limits;
+	SearchOptions options;
+	MoveOrderer<N> orderer;
+	Clock::time_point start;
+	uint64_t nodes = 0;
+	uint64_t cutoffs = 0;
+	uint64_t firstMoveCutoffs = 0;
+	uint64_t horizonHits = 0; // Leaves scored by the heuristic rather than the end of the game.
+	bool stopped = false;
+	uint64_t nextCheck = 1024; // Node count at which outOfBudget next reads the clock.
+	uint64_t reported = 0; // Nodes already added to the shared budget.
+	SharedBudget* shared;
+	WorkStealing<N>* pool = nullptr; // Set for YBWC, along with this searcher's thread index.
+	int thread = 0;
+	SplitPoint<N>* current = nullptr; // Innermost split point this thread is searching under.
+	bool patterns; // Leaves are scored by the pattern weights rather than the disc count.
+
+	inline double elapsed() const { return std::chrono::duration<double>(Clock::now() - start).count(); }
+	inline bool outOfBudget();
+	// Score of a leaf the search stops at before the end of the game.
+	inline int evaluate() const { return patterns ? Patterns.evaluate<N>(position.getBoard()) : DiscDifference(position.getBoard()); }
+	// Where iterative deepening can start on the root's moves, with the table's move put first.
+	int resumeDepth(MoveList<N>& moves) const;
+	// Out of budget, or a split point the current subtree belongs to no longer needs it.
+	inline bool cancelled() const;
+
+	template<SearchAlgorithm A>
+	SearchResult deepen(MoveList<N>& moves, int firstDepth);
+	template<SearchAlgorithm A>
+	int searchWindow(MoveList<N>& moves, int depth, int alpha, int beta, uint8_t& bestSquare);
+	template<SearchAlgorithm A>
+	int aspiration(MoveList<N>& moves, int depth, int guess, uint8_t& bestSquare);
+	template<SearchAlgorithm A>
+	int mtdf(MoveList<N>& moves, int depth, int guess, uint8_t& bestSquare);
+	template<SearchAlgorithm A>
+	int searchRoot(uint8_t square, int depth, int alpha, int beta, bool eldest);
+	template<SearchAlgorithm A>
+	int negamax(int depth, int alpha, int beta);
+	template<SearchAlgorithm A>
+	int solve(int alpha, int beta);
+	template<SearchAlgorithm A>
+	void split(const MoveList<N>& moves, int first, int depth, int& alpha, int beta, int& best, uint8_t& bestSquare);
+	template<SearchAlgorithm A>
+	void searchBrother(SplitPoint<N>& point, uint8_t square);
+};
+
+// The clock and the stop flag are read about every 1024 nodes, which keeps overshoot far below a
+// millisecond. The endgame solver counts its last empties in bulk, so the check goes by a
+// threshold rather than by exact multiples of 1024.
+// Threads sharing a budget also add their nodes to it at each check and stop each other.
+template<int N>
+inline bool Searcher<N>::outOfBudget() {
+	if (stopped) return true;
+	if (!shared && limits.nodes && nodes >= limits.nodes) stopped = true;
+	else if (nodes >= nextCheck) {
+		nextCheck = nodes + 1024;
+		if (shared) {
+			uint64_t counted = shared->nodes.fetch_add(nodes - reported, std::memory_order_relaxed) + nodes - reported;
+			reported = nodes;
+			if (limits.nodes && counted >= limits.nodes) stopped = true;
+			if (shared->stop.load(std::memory_order_relaxed)) stopped = true;
+		}
+		if (limits.seconds > 0 && elapsed() >= limits.seconds) stopped = true;
+		if (limits.stop && limits.stop->load(std::memory_order_relaxed)) stopped = true;
+	}
+	if (stopped && shared) shared->stop.store(true, std::memory_order_relaxed);
+	return stopped;
+}
+
+template<int N>
+inline bool Searcher<N>::cancelled() const {
+	if (stopped) return true;
+	for (const SplitPoint<N>* point = current; point; point = point->parent) {
+		if (point->aborted.load(std::memory_order_relaxed)) return true;
+	}
+	return false;
+}
+
+// Negamax over disc differences from the side to move, fail-soft: a result <= alpha is an upper
+// bound and a result >= beta a lower bound. At depth 0 the current disc difference stands in for
+// the final one. Passing does not use up depth.
+// PVS searches the first move with the full window and proves every later move with a zero window
+// around alpha, searching it again with the full window only when the proof fails high.
+// A subtree that never reached depth 0 is stored with EXACT_DEPTH, valid for any later depth.
+template<int N>
+template<SearchAlgorithm A>
+int Searcher<N>::negamax(int depth, int alpha, int beta) {
+	if (Empties<N>(position.getBoard()) <= depth) return solve<A>(alpha, beta);
+	nodes++;
+	if (outOfBudget()) return 0;
+	MoveList<N> moves;
+	GenerateMoves(position.getBoard(), moves);
+	if (moves.empty()) {
+		if (!LegalMoves<N>(Pass(position.getBoard()))) return DiscDifference(position.getBoard());
+		position.pass();
+		int value = -negamax<A>(depth, -beta, -alpha);
+		position.undo();
+		return value;
+	}
+	if (depth == 0) {
+		horizonHits++;
+		return evaluate();
+	}
+	bool useTable = depth >= TT_MIN_DEPTH;
+	TableKey key = useTable ? KeyOf(position) : TableKey{ 0, 0 };
+	TTEntry entry;
+	if (useTable && ProbeTable<N>(key, entry)) {
+		if (entry.depth >= depth && TTCutoff(entry, alpha, beta)) {
+			if (entry.depth != EXACT_DEPTH) horizonHits++;
+			return entry.score;
+		}
+	}
+	orderer.order(moves.squares.data(), moves.count, entry.move, position.getPly(), position.getSide());
+	uint64_t hitsBefore = horizonHits;
+	int alphaOrig = alpha;
+	int best = -SCORE_INFINITY;
+	uint8_t bestSquare = NO_MOVE;
+	for (int i = 0; i < moves.count; i++) {
+		uint8_t square = moves.squares[i];
+		if (i > 0 && pool && depth >= SPLIT_MIN_DEPTH && pool->hasIdleThreads()) {
+			split<A>(moves, i, depth, alpha, beta, best, bestSquare);
+			if (cancelled()) return 0;
+			if (best >= beta) {
+				cutoffs++;
+				orderer.onCutoff(bestSquare, position.getPly(), position.getSide(), depth);
+			}
+			break;
+		}
+		position.play(1ULL << square);
+		int value;
+		if (A == SearchAlgorithm::PVS && best != -SCORE_INFINITY) {
+			value = -negamax<A>(depth - 1, -alpha - 1, -alpha);
+			if (value > alpha && value < beta) value = -negamax<A>(depth - 1, -beta, -alpha);
+		} else {
+			value = -negamax<A>(depth - 1, -beta, -alpha);
+		}
+		position.undo();
+		if (cancelled()) return 0;
+		if (value > best) {
+			best = value;
+			bestSquare = square;
+			if (value > alpha) alpha = value;
+			if (alpha >= beta) {
+				cutoffs++;
+				if (square == moves.squares[0]) firstMoveCutoffs++;
+				orderer.onCutoff(square, position.getPly(), position.getSide(), depth);
+				break;
+			}
+		}
+	}
+	if (useTable) StoreTable<N>(key, best, horizonHits == hitsBefore ? EXACT_DEPTH : depth, BoundFor(best, alphaOrig, beta), bestSquare);
+	return best;
+}
+
+// Iterative deepening: each depth starts with the previous depth's best move and only a fully
+// searched depth replaces the answer. Deepening ends at the budget or once a depth reached the
+// end of the game in every line, which makes its score exact. Close to the end it skips
+// straight to the depth that solves the game, see NextDepth.
+// The first depth always gets the full window, later ones go through the chosen driver.
+template<int N>
+template<SearchAlgorithm A>
+SearchResult Searcher<N>::deepen(MoveList<N>& moves, int firstDepth) {
+	SearchResult result;
+	result.move = 1ULL << moves.squares[0];
+	int maxDepth = limits.depth ? limits.depth : MaxPly<N>();
+	int scores[2] = { 0, 0 }; // Last scores at odd and even depths.
+	int empties = Empties<N>(position.getBoard());
+	for (int depth = firstDepth; depth <= maxDepth && !result.exact; depth = NextDepth(depth, empties, options.solveEmpties, maxDepth)) {
+		uint64_t hitsBefore = horizonHits;
+		uint8_t bestSquare = moves.squares[0];
+		int guess = scores[depth & 1];
+		int bestValue;
+		if (depth > firstDepth + 1 && options.driver == SearchDriver::ASPIRATION) bestValue = aspiration<A>(moves, depth, guess, bestSquare);
+		else if (depth > firstDepth + 1 && options.driver == SearchDriver::MTDF) bestValue = mtdf<A>(moves, depth, guess, bestSquare);
+		else bestValue = searchWindow<A>(moves, depth, -SCORE_INFINITY, SCORE_INFINITY, bestSquare);
+		if (stopped) break;
+		moves.moveToFront(bestSquare);
+		result.move = 1ULL << bestSquare;
+		result.score = bestValue;
+		result.depth = depth;
+		result.exact = horizonHits == hitsBefore;
+		scores[depth & 1] = bestValue;
+	}
+	return result;
+}
+
+// The exact endgame solver, for nodes whose remaining depth covers every empty square. Scores
+// are the same final disc differences the search would find, and no depth limit applies.
+// Moves are tried table move first, then fastest first: fewest replies for the opponent, odd
+// quadrants breaking ties. Close to the end parity alone orders them, and the last LAST_EMPTIES
+// empties go to the list-free routines in endgame.h.
+template<int N>
+template<SearchAlgorithm A>
+int Searcher<N>::solve(int alpha, int beta) {
+	const Board& board = position.getBoard();
+	int empties = Empties<N>(board);
+	if (empties <= LAST_EMPTIES) {
+		int value = SolveLastEmpties<N>(board, alpha, beta, nodes);
+		outOfBudget();
+		return value;
+	}
+	nodes++;
+	if (outOfBudget()) return 0;
+	MoveList<N> moves;
+	GenerateMoves(board, moves);
+	if (moves.empty()) {
+		if (!LegalMoves<N>(Pass(board))) return DiscDifference(board);
+		position.pass();
+		int value = -solve<A>(-beta, -alpha);
+		position.undo();
+		return value;
+	}
+	TableKey key = KeyOf(position);
+	TTEntry entry;
+	if (ProbeTable<N>(key, entry) && entry.depth >= empties && TTCutoff(entry, alpha, beta)) return entry.score;
+	if (empties >= ETC_EMPTIES) {
+		// Enhanced transposition cutoff: a child already known to refute the window ends the node.
+		for (uint8_t square : moves) {
+			position.play(1ULL << square);
+			TTEntry child;
+			bool refutes = ProbeTable<N>(KeyOf(position), child) && child.depth >= empties - 1 && child.bound != Bound::LOWER && -child.score >= beta;
+			position.undo();
+			if (refutes) return -child.score;
+		}
+	}
+	uint64_t odd = OddQuadrants<N>(FullMask<N>() & ~(board.player | board.opponent));
+	int scores[SquareCount<N>()];
+	for (int i = 0; i < moves.count; i++) {
+		uint8_t square = moves.squares[i];
+		uint64_t move = 1ULL << square;
+		int score = (odd & move) ? 1 : 0;
+		if (square == entry.move) score = 1 << 20;
+		else if (empties >= FASTEST_FIRST_EMPTIES) {
+			uint64_t flips = Flips<N>(board, move);
+			uint64_t replies = LegalMoves<N>(Board(board.opponent ^ flips, board.player ^ flips ^ move));
+			score -= 4 * (PopCount(replies) + PopCount(replies & CornerMask<N>()));
+		}
+		int j = i;
+		for (; j > 0 && scores[j - 1] < score; j--) {
+			scores[j] = scores[j - 1];
+			moves.squares[j] = moves.squares[j - 1];
+		}
+		scores[j] = score;
+		moves.squares[j] = square;
+	}
+	int alphaOrig = alpha;
+	int best = -SCORE_INFINITY;
+	uint8_t bestSquare = NO_MOVE;
+	for (int i = 0; i < moves.count; i++) {
+		uint8_t square = moves.squares[i];
+		if (i > 0 && pool && empties >= SPLIT_MIN_EMPTIES && pool->hasIdleThreads()) {
+			split<A>(moves, i, empties, alpha, beta, best, bestSquare);
+			if (cancelled()) return 0;
+			break;
+		}
+		position.play(1ULL << square);
+		int value;
+		if (A == SearchAlgorithm::PVS && best != -SCORE_INFINITY) {
+			value = -solve<A>(-alpha - 1, -alpha);
+			if (value > alpha && value < beta) value = -solve<A>(-beta, -alpha);
+		} else {
+			value = -solve<A>(-beta, -alpha);
+		}
+		position.undo();
+		if (cancelled()) return 0;
+		if (value > best) {
+			best = value;
+			bestSquare = square;
+			if (value > alpha) alpha = value;
+			if (alpha >= beta) break;
+		}
+	}
+	StoreTable<N>(key, best, EXACT_DEPTH, BoundFor(best, alphaOrig, beta), bestSquare); // Reached the end in every line, a cutoff on it is no horizon hit.
+	return best;
+}
+
+// Young Brothers Wait: once the eldest child of a node is searched without a cutoff, the brothers
+// from first on go to this thread's deque, where idle threads can steal them. This thread searches
+// the ones nobody took, newest first. While the stolen ones run it helps with brothers offered
+// below them, whose results it is waiting for anyway, and sleeps when there are none. A cutoff
+// aborts the split point, which cancels every brother still running, including any split points
+// below them.
+template<int N>
+template<SearchAlgorithm A>
+void Searcher<N>::split(const MoveList<N>& moves, int first, int depth, int& alpha, int beta, int& best, uint8_t& bestSquare) {
+	SplitPoint<N> point;
+	point.board = position.getBoard();
+	point.side = position.getSide();
+	point.ply = position.getPly();
+	point.depth = depth;
+	point.beta = beta;
+	point.parent = current;
+	point.best = best;
+	point.bestSquare = bestSquare;
+	point.alpha = alpha;
+	point.pending = moves.count - first;
+	uint64_t hitsBefore = horizonHits;
+	pool->offer(thread, point, moves, first);
+	uint8_t square;
+	while (pool->takeBack(thread, &point, square)) searchBrother<A>(point, square);
+	SplitPoint<N>* below;
+	while (point.pending.load() > 0) {
+		if (pool->stealBelow(thread, &point, below, square)) {
+			Position<N> node = position;
+			position = Position<N>(below->board, below->side, below->ply);
+			searchBrother<A>(*below, square);
+			position = node;
+			continue;
+		}
+		// Woken by each brother that finishes, and now and then to look for new work below.
+		std::unique_lock<std::mutex> lock(point.mutex);
+		point.finished.wait_for(lock, std::chrono::microseconds(200), [&] { return point.pending.load() == 0; });
+	}
+	// The last brother signals under the lock, so once this thread holds it nobody touches point again.
+	std::lock_guard<std::mutex> lock(point.mutex);
+	horizonHits = hitsBefore + point.horizonHits; // The horizon hits of every brother, whoever searched it.
+	alpha = point.alpha;
+	best = point.best;
+	bestSquare = point.bestSquare;
+}
+
+// Searches square from the split point's node. The thread that split already stands on the node,
+// any other thread has been moved there by the pool.
+template<int N>
+template<SearchAlgorithm A>
+void Searcher<N>::searchBrother(SplitPoint<N>& point, uint8_t square) {
+	SplitPoint<N>* outer = current;
+	current = &point;
+	if (!cancelled()) {
+		uint64_t hitsBefore = horizonHits;
+		int alpha = point.alpha;
+		position.play(1ULL << square);
+		int value;
+		if (A == SearchAlgorithm::PVS) {
+			value = -negamax<A>(point.depth - 1, -alpha - 1, -alpha);
+			if (value > alpha && value < point.beta) value = -negamax<A>(point.depth - 1, -point.beta, -alpha);
+		} else {
+			value = -negamax<A>(point.depth - 1, -point.beta, -alpha);
+		}
+		position.undo();
+		if (!cancelled()) {
+			point.update(value, square);
+			point.horizonHits += horizonHits - hitsBefore;
+		}
+	}
+	current = outer;
+	// Last, the split point may be gone once the lock is released.
+	std::lock_guard<std::mutex> lock(point.mutex);
+	point.pending--;
+	point.finished.notify_all();
+}
+
+// Searches the root moves within (alpha, beta), fail-soft like negamax.
+// Each root move has to beat the best value so far, so a move that only ties it fails low and
+// the first of several equal moves is kept.
+template<int N>
+template<SearchAlgorithm A>
+int Searcher<N>::searchWindow(MoveList<N>& moves, int depth, int alpha, int beta, uint8_t& bestSquare) {
+	int best = -SCORE_INFINITY;
+	for (uint8_t square : moves) {
+		int value = searchRoot<A>(square, depth, std::max(alpha, best), beta, best == -SCORE_INFINITY);
+		if (stopped) break;
+		if (value > best) {
+			bestSquare = square;
+			best = value;
+			if (best >= beta) break;
+		}
+	}
+	return best;
+}
+
+// Aspiration windows: a window of ASPIRATION_WINDOW discs either side of the last depth's score,
+// doubled and moved past the result on every fail low or high until the score lands inside it.
+template<int N>
+template<SearchAlgorithm A>
+int Searcher<N>::aspiration(MoveList<N>& moves, int depth, int guess, uint8_t& bestSquare) {
+	int delta = ASPIRATION_WINDOW;
+	int alpha = std::max(guess - delta, -SCORE_INFINITY), beta = std::min(guess + delta, SCORE_INFINITY);
+	for (;;) {
+		int value = searchWindow<A>(moves, depth, alpha, beta, bestSquare);
+		if (stopped) return value;
+		delta *= 2;
+		if (value <= alpha && alpha > -SCORE_INFINITY) alpha = std::max(value - delta, -SCORE_INFINITY);
+		else if (value >= beta && beta < SCORE_INFINITY) beta = std::min(value + delta, SCORE_INFINITY);
+		else return value;
+	}
+}
+
+// MTD(f): zero window searches from the last depth's score, each narrowing the bounds on the
+// score until they meet. The move is the one that made the last fail high, the first root move
+// to reach the final score, just like the full window.
+template<int N>
+template<SearchAlgorithm A>
+int Searcher<N>::mtdf(MoveList<N>& moves, int depth, int guess, uint8_t& bestSquare) {
+	int lower = -SCORE_INFINITY, upper = SCORE_INFINITY, value = guess;
+	while (lower < upper) {
+		int beta = value == lower ? value + 1 : value;
+		uint8_t square = bestSquare;
+		value = searchWindow<A>(moves, depth, beta - 1, beta, square);
+		if (stopped) return value;
+		if (value < beta) {
+			upper = value;
+		} else {
+			lower = value;
+			bestSquare = square;
+		}
+	}
+	return value;
+}
+
+// Searches one root move within (alpha, beta). PVS proves every move but the eldest with a zero
+// window first.
+template<int N>
+template<SearchAlgorithm A>
+int Searcher<N>::searchRoot(uint8_t square, int depth, int alpha, int beta, bool eldest) {
+	position.play(1ULL << square);
+	int value;
+	if (A == SearchAlgorithm::PVS && !eldest) {
+		value = -negamax<A>(depth - 1, -alpha - 1, -alpha);
+		if (value > alpha && value < beta) value = -negamax<A>(depth - 1, -beta, -alpha);
+	} else {
+		value = -negamax<A>(depth - 1, -beta, -alpha);
+	}
+	position.undo();
+	return value;
+}
+
+// The last decision searched this root two plies down, when the game went the way it expected, and
+// left its result in the table. The depths below that one are skipped, they would only fill the
+// table with what it already holds.
+template<int N>
+int Searcher<N>::resumeDepth(MoveList<N>& moves) const {
+	TTEntry entry;
+	if (!ProbeTable<N>(KeyOf(position), entry)) return 1;
+	if (entry.move != NO_MOVE) moves.moveToFront(entry.move);
+	int maxDepth = limits.depth ? limits.depth : MaxPly<N>();
+	if (entry.move == NO_MOVE || entry.depth < TT_MIN_DEPTH || entry.depth == EXACT_DEPTH) return 1;
+	return std::min(entry.depth, maxDepth);
+}
+
+template<int N>
+SearchResult Searcher<N>::run(int firstDepth) {
+	MoveList<N> moves;
+	GenerateMoves(position.getBoard(), moves);
+	bool forced = moves.count == 1;
+	PruneSymmetricMoves(position.getBoard(), moves); // Equal moves are still searched once, for the score.
+	SearchResult result;
+	if (forced) result.move = 1ULL << moves.squares[0]; // Nothing to decide.
+	else if (!moves.empty()) {
+		int maxDepth = limits.depth ? limits.depth : MaxPly<N>();
+		firstDepth = std::min(firstDepth + resumeDepth(moves) - 1, maxDepth);
+		if (options.algorithm == SearchAlgorithm::PVS) result = deepen<SearchAlgorithm::PVS>(moves, firstDepth);
+		else result = deepen<SearchAlgorithm::ALPHA_BETA>(moves, firstDepth);
+	}
+	result.nodes = nodes;
+	result.cutoffs = cutoffs;
+	result.firstMoveCutoffs = firstMoveCutoffs;
+	result.seconds = elapsed();
+	return result;
+}
+
+// Root splitting: every iteration the main thread searches the first root move alone, then the
+// pool of threads takes the remaining moves one at a time, each with its own Searcher sharing the
+// table and the budget. The best value so far and the index of its move are published under a
+// lock as soon as a move improves them and every move started later is searched above them.
+// A move earlier in the order than the current best only has to reach its value, so the first of
+// several equal moves still wins and the answer matches the single threaded search to the same depth.
+template<int N>
+class RootSplit {
+public:
+	RootSplit(const Board& board, int side, const SearchLimits& limits, const SearchOptions& options);
+	~RootSplit();
+
+	SearchResult run();
+
+private:
+	template<SearchAlgorithm A>
+	SearchResult deepen();
+	template<SearchAlgorithm A>
+	void searchMove(Searcher<N>& searcher, int index);
+	template<SearchAlgorithm A>
+	void work(Searcher<N>& searcher);
+	void help(int thread);
+	void sync();
+
+	SearchLimits limits;
+	SearchOptions options;
+	SharedBudget budget;
+	std::vector<std::unique_ptr<Searcher<N>>> searchers; // The main thread's first.
+
+	std::mutex mutex;
+	std::condition_variable arrived;
+	int waiting = 0;
+	int generation = 0; // Rounds of sync() so far.
+	bool done = false;
+
+	// The current iteration, written by the main thread before the helpers are released.
+	MoveList<N> moves;
+	int depth = 0;
+	std::atomic<int> next{ 0 };
+	int bestValue = -SCORE_INFINITY; // Guarded by mutex, like bestIndex.
+	int bestIndex = 0;
+
+	std::vector<std::thread> threads;
+};
+
+template<int N>
+RootSplit<N>::RootSplit(const Board& board, int side, const SearchLimits& limits, const SearchOptions& options)
+	: limits(limits), options(options) {
+	GenerateMoves(board, moves);
+	PruneSymmetricMoves(board, moves);
+	for (int i = 0; i < options.threads; i++) searchers.emplace_back(new Searcher<N>(board, side, limits, options, &budget));
+	for (int i = 1; i < options.threads; i++) threads.emplace_back(&RootSplit<N>::help, this, i);
+}
+
+template<int N>
+RootSplit<N>::~RootSplit() {
+	done = true;
+	sync();
+	for (std::thread& thread : threads) thread.join();
+}
+
+// Barrier for the main thread and every helper.
+template<int N>
+void RootSplit<N>::sync() {
+	std::unique_lock<std::mutex> lock(mutex);
+	int round = generation;
+	if (++waiting == (int)searchers.size()) {
+		waiting = 0;
+		generation++;
+		arrived.notify_all();
+	} else {
+		arrived.wait(lock, [&]() { return generation != round; });
+	}
+}
+
+template<int N>
+void RootSplit<N>::help(int thread) {
+	for (;;) {
+		sync();
+		if (done) return;
+		if (options.algorithm == SearchAlgorithm::PVS) work<SearchAlgorithm::PVS>(*searchers[thread]);
+		else work<SearchAlgorithm::ALPHA_BETA>(*searchers[thread]);
+		sync();
+	}
+}
+
+template<int N>
+template<SearchAlgorithm A>
+void RootSplit<N>::searchMove(Searcher<N>& searcher, int index) {
+	int alpha;
+	bool eldest;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		eldest = bestValue == -SCORE_INFINITY;
+		alpha = index < bestIndex && !eldest ? bestValue - 1 : bestValue;
+	}
+	int value = searcher.template searchRoot<A>(moves.squares[index], depth, alpha, SCORE_INFINITY, eldest);
+	if (searcher.stopped) return;
+	std::lock_guard<std::mutex> lock(mutex);
+	if (value > bestValue || (value == bestValue && index < bestIndex)) {
+		bestValue = value;
+		bestIndex = index;
+	}
+}
+
+template<int N>
+template<SearchAlgorithm A>
+void RootSplit<N>::work(Searcher<N>& searcher) {
+	for (int index = next++; index < moves.count && !budget.stop; index = next++) searchMove<A>(searcher, index);
+}
+
+template<int N>
+template<SearchAlgorithm A>
+SearchResult RootSplit<N>::deepen() {
+	Searcher<N>& main = *searchers[0];
+	SearchResult result;
+	int firstDepth = main.resumeDepth(moves);
+	result.move = 1ULL << moves.squares[0];
+	int maxDepth = limits.depth ? limits.depth : MaxPly<N>();
+	int empties = Empties<N>(main.position.getBoard());
+	for (depth = firstDepth; depth <= maxDepth && !result.exact; depth = NextDepth(depth, empties, options.solveEmpties, maxDepth)) {
+		uint64_t hitsBefore = 0;
+		for (auto& searcher : searchers) hitsBefore += searcher->horizonHits;
+		bestValue = -SCORE_INFINITY;
+		bestIndex = moves.count;
+		next = 1;
+		searchMove<A>(main, 0);
+		sync();
+		work<A>(main);
+		sync();
+		if (budget.stop) break;
+		uint64_t hits = 0;
+		for (auto& searcher : searchers) hits += searcher->horizonHits;
+		uint8_t bestSquare = moves.squares[bestIndex];
+		moves.moveToFront(bestSquare);
+		result.move = 1ULL << bestSquare;
+		result.score = bestValue;
+		result.depth = depth;
+		result.exact = hits == hitsBefore;
+	}
+	return result;
+}
+
+template<int N>
+SearchResult RootSplit<N>::run() {
+	SearchResult result;
+	if (options.algorithm == SearchAlgorithm::PVS) result = deepen<SearchAlgorithm::PVS>();
+	else result = deepen<SearchAlgorithm::ALPHA_BETA>();
+	for (auto& searcher : searchers) {
+		result.nodes += searcher->nodes;
+		result.cutoffs += searcher->cutoffs;
+		result.firstMoveCutoffs += searcher->firstMoveCutoffs;
+	}
+	result.seconds = searchers[0]->elapsed();
+	return result;
+}
+
+// Lazy SMP: helper threads run the same iterative deepening as the main thread, each on its own
+// Searcher, and share nothing but the transposition table and the budget. Every other helper
+// starts a depth ahead so the threads spread over two depths and feed each other through the table.
+// The answer is always the main thread's, the helpers are stopped as soon as it has one.
+template<int N>
+SearchResult LazySMP(const Board& board, int side, const SearchLimits& limits, const SearchOptions& options) {
+	SharedBudget budget;
+	std::vector<std::unique_ptr<Searcher<N>>> searchers;
+	for (int i = 0; i < options.threads; i++) searchers.emplace_back(new Searcher<N>(board, side, limits, options, &budget));
+	std::vector<SearchResult> helperResults(options.threads);
+	std::vector<std::thread> helpers;
+	for (int i = 1; i < options.threads; i++) {
+		helpers.emplace_back([&searchers, &helperResults, i]() { helperResults[i] = searchers[i]->run(1 + i % 2); });
+	}
+	SearchResult result = searchers[0]->run();
+	budget.stop = true;
+	for (std::thread& helper : helpers) helper.join();
+	for (int i = 1; i < options.threads; i++) {
+		result.nodes += helperResults[i].nodes;
+		result.cutoffs += helperResults[i].cutoffs;
+		result.firstMoveCutoffs += helperResults[i].firstMoveCutoffs;
+	}
+	return result;
+}
+
+// The threads of a YBWC search. The main thread runs the usual iterative deepening and splits
+// nodes as it goes; helpers steal brothers from the front of other threads' deques, oldest and
+// so nearest the root first, and may split again below them.
+template<int N>
+class WorkStealing {
+public:
+	WorkStealing(const Board& board, int side, const SearchLimits& limits, const SearchOptions& options);
+	~WorkStealing();
+
+	SearchResult run();
+
+	inline bool hasIdleThreads() const { return idle.load(std::memory_order_relaxed) > 0; }
+	// Puts the moves from first on at the back of thread's deque as brothers of point.
+	void offer(int thread, SplitPoint<N>& point, const MoveList<N>& moves, int first);
+	// Takes the newest brother of point still on thread's own deque, if any.
+	bool takeBack(int thread, const SplitPoint<N>* point, uint8_t& square);
+	// Takes a brother from another thread's deque whose split point lies below point, if any.
+	bool stealBelow(int thread, const SplitPoint<N>* point, SplitPoint<N>*& below, uint8_t& square);
+
+private:
+	struct Brother {
+		SplitPoint<N>* point;
+		uint8_t square;
+	};
+	struct Deque {
+		std::mutex mutex;
+		std::deque<Brother> brothers;
+	};
+
+	bool steal(int thread, Brother& brother);
+	template<SearchAlgorithm A>
+	void help(int thread);
+
+	SearchOptions options;
+	SharedBudget budget;
+	std::vector<std::unique_ptr<Searcher<N>>> searchers; // The main thread's first.
+	std::vector<std::unique_ptr<Deque>> deques;
+	std::atomic<int> idle{ 0 };
+	std::atomic<bool> done{ false };
+	std::vector<std::thread> threads;
+};
+
+template<int N>
+WorkStealing<N>::WorkStealing(const Board& board, int side, const SearchLimits& limits, const SearchOptions& options) : options(options) {
+	for (int i = 0; i < options.threads; i++) {
+		searchers.emplace_back(new Searcher<N>(board, side, limits, options, &budget));
+		searchers[i]->pool = this;
+		searchers[i]->thread = i;
+		deques.emplace_back(new Deque());
+	}
+	for (int i = 1; i < options.threads; i++) {
+		if (options.algorithm == SearchAlgorithm::PVS) threads.emplace_back(&WorkStealing<N>::help<SearchAlgorithm::PVS>, this, i);
+		else threads.emplace_back(&WorkStealing<N>::help<SearchAlgorithm::ALPHA_BETA>, this, i);
+	}
+}
+
+template<int N>
+WorkStealing<N>::~WorkStealing() {
+	done = true;
+	for (std::thread& thread : threads) {
+		if (thread.joinable()) thread.join();
+	}
+}
+
+template<int N>
+void WorkStealing<N>::offer(int thread, SplitPoint<N>& point, const MoveList<N>& moves, int first) {
+	std::lock_guard<std::mutex> lock(deques[thread]->mutex);
+	for (int i = moves.count - 1; i >= first; i--) deques[thread]->brothers.push_back({ &point, moves.squares[i] });
+}
+
+template<int N>
+bool WorkStealing<N>::takeBack(int thread, const SplitPoint<N>* point, uint8_t& square) {
+	std::lock_guard<std::mutex> lock(deques[thread]->mutex);
+	std::deque<Brother>& brothers = deques[thread]->brothers;
+	if (brothers.empty() || brothers.back().point != point) return false;
+	square = brothers.back().square;
+	brothers.pop_back();
+	return true;
+}
+
+template<int N>
+bool WorkStealing<N>::stealBelow(int thread, const SplitPoint<N>* point, SplitPoint<N>*& below, uint8_t& square) {
+	for (int i = 1; i < (int)deques.size(); i++) {
+		Deque& victim = *deques[(thread + i) % deques.size()];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		// A split point with a brother still queued is waiting for it, and so are the ones above it.
+		for (auto brother = victim.brothers.begin(); brother != victim.brothers.end(); ++brother) {
+			const SplitPoint<N>* ancestor = brother->point->parent;
+			while (ancestor && ancestor != point) ancestor = ancestor->parent;
+			if (!ancestor) continue;
+			below = brother->point;
+			square = brother->square;
+			victim.brothers.erase(brother);
+			return true;
+		}
+	}
+	return false;
+}
+
+template<int N>
+bool WorkStealing<N>::steal(int thread, Brother& brother) {
+	for (int i = 1; i < (int)deques.size(); i++) {
+		Deque& victim = *deques[(thread + i) % deques.size()];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (victim.brothers.empty()) continue;
+		brother = victim.brothers.front();
+		victim.brothers.pop_front();
+		return true;
+	}
+	return false;
+}
+
+template<int N>
+template<SearchAlgorithm A>
+void WorkStealing<N>::help(int thread) {
+	Searcher<N>& searcher = *searchers[thread];
+	idle++;
+	while (!done) {
+		Brother brother;
+		if (!steal(thread, brother)) {
+			std::this_thread::yield();
+			continue;
+		}
+		idle--;
+		const SplitPoint<N>& point = *brother.point;
+		searcher.position = Position<N>(point.board, point.side, point.ply);
+		searcher.template searchBrother<A>(*brother.point, brother.square);
+		idle++;
+	}
+}
+
+template<int N>
+SearchResult WorkStealing<N>::run() {
+	SearchResult result = searchers[0]->run();
+	done = true;
+	for (std::thread& thread : threads) thread.join();
+	for (size_t i = 1; i < searchers.size(); i++) {
+		result.nodes += searchers[i]->nodes;
+		result.cutoffs += searchers[i]->cutoffs;
+		result.firstMoveCutoffs += searchers[i]->firstMoveCutoffs;
+	}
+	return result;
+}
+
+template<int N>
+SearchResult MiniMaxDecision(const Board& board, int side, const SearchLimits& limits, const SearchOptions& options) {
+	SolvedEntry solved;
+	if (N == 4 && SolvedGame.probe(board, solved)) {
+		SearchResult result;
+		result.move = solved.move == NO_MOVE ? 0 : 1ULL << solved.move;
+		result.score = solved.score;
+		result.depth = Empties<N>(board);
+		result.exact = true;
+		result.solved = true;
+		return result;
+	}
+	BookEntry booked;
+	if (Book.probe<N>(board, booked) && (LegalMoves<N>(board) & (1ULL << booked.move))) {
+		SearchResult result;
+		result.move = 1ULL << booked.move;
+		result.score = booked.score;
+		result.depth = booked.depth;
+		result.book = true;
+		return result;
+	}
+	TransTable.newGeneration();
+	if (options.threads > 1 && PopCount(LegalMoves<N>(board)) > 1) {
+		if (options.parallel == ParallelSearch::LAZY_SMP) return LazySMP<N>(board, side, limits, options);
+		if (options.parallel == ParallelSearch::YBWC) {
+			WorkStealing<N> search(board, side, limits, options);
+			return search.run();
+		}
+		RootSplit<N> search(board, side, limits, options);
+		return search.run();
+	}
+	Searcher<N> searcher(board, side, limits, options);
+	return searcher.run();
+}
+
+SearchResult MiniMaxDecision(const Board& board, int size, int side, const SearchLimits& limits, const SearchOptions& options) {
+	switch (size) {
+		case 6: return MiniMaxDecision<6>(board, side, limits, options);
+		case 8: return MiniMaxDecision<8>(board, side, limits, options);
+		default: return MiniMaxDecision<4>(board, side, limits, options);
+	}
+}
+
+template SearchResult MiniMaxDecision<4>(const Board& board, int side, const SearchLimits& limits, const SearchOptions& options);
+template SearchResult MiniMaxDecision<6>(const Board& board, int side, const SearchLimits& limits, const SearchOptions& options);
+template SearchResult MiniMaxDecision<8>(const Board& board, int side, const SearchLimits& limits, const SearchOptions& options);
+
+template<int N>
+uint64_t HashMove(const Board& board, int side) {
+	TTEntry entry;
+	if (!ProbeTable<N>(KeyOf<N>(board, ZobristHash(board, side)), entry) || entry.move == NO_MOVE) return 0;
+	return LegalMoves<N>(board) & (1ULL << entry.move);
+}
+
+uint64_t HashMove(const Board& board, int size, int side) {
+	switch (size) {
+		case 6: return HashMove<6>(board, side);
+		case 8: return HashMove<8>(board, side);
+		default: return HashMove<4>(board, side);
+	}
+}
@@ -0,0 +1,247 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "bitboard.h"
+#include "endgame.h"
+#include "ordering.h"
+#include "pattern.h"
+#include "playout.h"
+#include "symmetry.h"
+#include "transposition.h"
+#include "zobrist.h"
+
+// A game lasts at most one move per square plus one pass before each of them.
+template<int N>
+constexpr int MaxPly() {
+	return 2 * SquareCount<N>();
+}
+
+// Stack-resident list of the legal moves at one node, a node never has more moves than squares.
+template<int N>
+struct MoveList {
+	std::array<uint8_t, SquareCount<N>()> squares;
+	int count = 0;
+
+	inline const uint8_t* begin() const { return squares.data(); }
+	inline const uint8_t* end() const { return squares.data() + count; }
+	inline bool empty() const { return count == 0; }
+
+	// Moves square to the front if it is in the list, keeping the order of the rest.
+	inline void moveToFront(uint8_t square) {
+		for (int i = 0; i < count; i++) {
+			if (squares[i] != square) continue;
+			for (; i > 0; i--) squares[i] = squares[i - 1];
+			squares[0] = square;
+			return;
+		}
+	}
+};
+
+template<int N>
+inline void GenerateMoves(const Board& board, MoveList<N>& list) {
+	list.count = 0;
+	for (uint64_t moves = LegalMoves<N>(board); moves; moves &= moves - 1) {
+		list.squares[list.count++] = (uint8_t)LowestSquare(moves);
+	}
+}
+
+struct Undo {
+	uint64_t flips;
+	uint64_t move;
+	uint64_t hash;
+};
+
+// The board being searched, changed in place by play/pass and reverted by undo.
+// The Zobrist hash of the board and the colour to move are kept up to date along with it.
+// ply counts the moves from the root, a search that starts below the root passes its distance.
+template<int N>
+class Position {
+public:
+	Position(const Board& board, int side, int ply = 0) : board(board), hash(ZobristHash(board, side)), side(side), ply(ply) {}
+
+	inline const Board& getBoard() const { return board; }
+	inline uint64_t getHash() const { return hash; }
+	inline int getSide() const { return side; }
+	inline int getPly() const { return ply; }
+
+	inline void play(uint64_t move) {
+		uint64_t flips = Flips<N>(board, move);
+		undoStack[ply++] = { flips, move, hash };
+		board = Board(board.opponent ^ flips, board.player ^ flips ^ move);
+		hash ^= ZobristMoveDelta(move, flips, side);
+		side ^= 1;
+	}
+
+	inline void pass() {
+		undoStack[ply++] = { 0, 0, hash };
+		board = Pass(board);
+		hash ^= Zobrist.side;
+		side ^= 1;
+	}
+
+	inline void undo() {
+		const Undo& last = undoStack[--ply];
+		board = Board(board.opponent ^ last.flips ^ last.move, board.player ^ last.flips);
+		hash = last.hash;
+		side ^= 1;
+	}
+
+private:
+	Board board;
+	uint64_t hash;
+	int side;
+	int ply;
+	std::array<Undo, MaxPly<N>()> undoStack;
+};
+
+inline int Utility(const Board& board) {
+	return PopCount(board.player);
+}
+
+// What the search maximizes: the side to move's discs minus the opponent's.
+inline int DiscDifference(const Board& board) {
+	return PopCount(board.player) - PopCount(board.opponent);
+}
+
+// Early in the game the table is keyed by the canonical form, so every image of a position under
+// the board's symmetries finds the same entry, with its move stored for the canonical image. Later
+// on images rarely meet within one search and the incremental Zobrist hash is cheaper.
+template<int N>
+constexpr int SymmetricPlies() {
+	return SquareCount<N>() / 4;
+}
+
+struct TableKey {
+	uint64_t key;
+	int symmetry; // Maps the position onto the orientation of its entry.
+};
+
+template<int N>
+inline TableKey KeyOf(const Board& board, uint64_t hash) {
+	TableKey key{ hash, 0 };
+	if (PopCount(board.player | board.opponent) - 4 < SymmetricPlies<N>()) key.key = CanonicalHash<N>(board, key.symmetry);
+	return key;
+}
+
+template<int N>
+inline TableKey KeyOf(const Position<N>& position) {
+	return KeyOf<N>(position.getBoard(), position.getHash());
+}
+
+// Drops the root moves that lead to an image of a position an earlier move reaches: on a board
+// some symmetry maps onto itself, the moves it maps onto each other are worth the same.
+template<int N>
+inline void PruneSymmetricMoves(const Board& board, MoveList<N>& moves) {
+	uint32_t symmetries = SelfSymmetries<N>(board);
+	if (!symmetries) return;
+	int kept = 0;
+	for (int i = 0; i < moves.count; i++) {
+		uint8_t square = moves.squares[i];
+		bool duplicate = false;
+		for (int symmetry = 1; symmetry < SYMMETRIES && !duplicate; symmetry++) {
+			if (!(symmetries & (1u << symmetry))) continue;
+			uint8_t image = TransformSquare<N>(square, symmetry);
+			for (int j = 0; j < kept; j++) duplicate |= moves.squares[j] == image;
+		}
+		if (!duplicate) moves.squares[kept++] = square;
+	}
+	moves.count = kept;
+}
+
+// Bounds every score lies strictly inside.
+constexpr int SCORE_INFINITY = 1000;
+
+constexpr size_t DEFAULT_HASH_MEGABYTES = 16;
+extern TranspositionTable TransTable;
+
+// Depth stored for results that reached the end of the game in every line.
+constexpr int EXACT_DEPTH = 255;
+
+template<int N>
+inline bool ProbeTable(const TableKey& key, TTEntry& entry) {
+	if (!TransTable.probe(key.key, entry)) return false;
+	if (entry.move != NO_MOVE) entry.move = InverseSquare<N>(entry.move, key.symmetry);
+	return true;
+}
+
+template<int N>
+inline void StoreTable(const TableKey& key, int score, int depth, Bound bound, uint8_t move) {
+	TransTable.store(key.key, score, depth, bound, move == NO_MOVE ? NO_MOVE : TransformSquare<N>(move, key.symmetry));
+}
+
+constexpr double DEFAULT_MOVE_SECONDS = .4;
+// The endgame solver finishes 16 empties on 8x8 well within the default move time.
+constexpr int DEFAULT_SOLVE_EMPTIES = 16;
+
+// Budget of one move decision, a zero leaves that limit off.
+struct SearchLimits {
+	double seconds = DEFAULT_MOVE_SECONDS;
+	uint64_t nodes = 0;
+	int depth = 0; // Deepest iteration.
+	const std::atomic<bool>* stop = nullptr; // Set from another thread to end the search early.
+};
+
+enum class SearchAlgorithm { ALPHA_BETA, PVS };
+
+// How each depth of the iterative deepening is searched at the root: with the full window, with
+// a narrow window around the last depth's score, or as a series of zero window probes.
+enum class SearchDriver { FULL_WINDOW, ASPIRATION, MTDF };
+
+// How more than one thread share a search: root splitting hands each thread whole root moves and
+// keeps the single threaded answer, Lazy SMP runs every thread on the whole tree through one table
+// and YBWC splits inner nodes, offering the younger brothers to idle threads once the eldest is searched.
+enum class ParallelSearch { ROOT_SPLIT, LAZY_SMP, YBWC };
+
+struct SearchOptions {
+	SearchAlgorithm algorithm = SearchAlgorithm::PVS;
+	uint32_t ordering = ORDER_DEFAULT; // OrderingFlags.
+	int threads = 1;
+	ParallelSearch parallel = ParallelSearch::ROOT_SPLIT; // How threads beyond the first help.
+	SearchDriver driver = SearchDriver::FULL_WINDOW; // Root splitting always uses the full window.
+	int solveEmpties = DEFAULT_SOLVE_EMPTIES; // Empties at which the search solves the game outright.
+	PlayoutKernel playouts = BestPlayoutKernel(); // How the Monte Carlo player runs its random games.
+	Evaluation evaluation = Evaluation::PATTERNS; // Falls back to the disc count without weights for the board size.
+};
+
+// Cores the machine reports, at least one.
+int HardwareThreads();
+
+// Reads "alphabeta" or "pvs", as given on the command line.
+bool ParseSearchAlgorithm(const std::string& name, SearchAlgorithm& algorithm);
+// Reads "full", "aspiration" or "mtdf".
+bool ParseSearchDriver(const std::string& name, SearchDriver& driver);
+// Reads "rootsplit", "lazysmp" or "ybwc".
+bool ParseParallelSearch(const std::string& name, ParallelSearch& parallel);
+// Reads a comma separated list of tt, killers, history and squares, or none.
+bool ParseOrdering(const std::string& list, uint32_t& flags);
+
+struct SearchResult {
+	uint64_t move = 0; // Zero if the side to move has no legal move.
+	int score = 0;
+	int depth = 0; // Last depth searched completely.
+	bool exact = false; // The score is the final disc difference, not an estimate.
+	bool solved = false; // Looked up in the solved database, nothing was searched.
+	bool book = false; // Played from the opening book, nothing was searched.
+	uint64_t nodes = 0;
+	uint64_t cutoffs = 0; // Nodes that failed high.
+	uint64_t firstMoveCutoffs = 0; // Of those, nodes whose first move already failed high.
+	uint64_t playouts = 0; // Random games played, by the Monte Carlo player only.
+	double seconds = 0.0;
+};
+
+// Picks the move the side to move should play within limits.
+// side is the colour of board.player, 0 for the first player and 1 for the second.
+// On 4x4 the move comes straight from the solved database when the game has loaded one, and
+// in the opening from the book.
+template<int N>
+SearchResult MiniMaxDecision(const Board& board, int side, const SearchLimits& limits, const SearchOptions& options);
+
+// Picks the specialization for size once, the search itself never checks the size again.
+SearchResult MiniMaxDecision(const Board& board, int size, int side, const SearchLimits& limits, const SearchOptions& options);
+
+// The best move the transposition table remembers for board, 0 if it has none. The reply the
+// last search expected, which pondering searches ahead of.
+uint64_t HashMove(const Board& board, int size, int side);
@@ -0,0 +1,117 @@
+#include "solved.h"
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+SolvedDatabase SolvedGame;
+
+// File layout: SOLVED_MAGIC, then the version and the slot count as 32 bit numbers, then the slots.
+static const char SOLVED_MAGIC[8] = { 'O', 'T', 'H', 'S', 'O', 'L', 'V', '4' };
+constexpr uint32_t SOLVED_VERSION = 1;
+constexpr size_t SOLVED_HEADER = 16;
+
+inline uint32_t HomeSlot(uint32_t key, uint32_t mask) {
+	return (uint32_t)MixBits(key) & mask;
+}
+
+bool SolvedDatabase::open(const std::string& path) {
+	slots = nullptr;
+	if (!file.open(path)) return false;
+	uint32_t header[2] = { 0, 0 };
+	if (file.size() > SOLVED_HEADER) std::memcpy(header, file.data() + sizeof(SOLVED_MAGIC), sizeof(header));
+	uint32_t count = header[1];
+	if (std::memcmp(file.data(), SOLVED_MAGIC, sizeof(SOLVED_MAGIC)) != 0 || header[0] != SOLVED_VERSION
+		|| count == 0 || (count & (count - 1)) != 0 || file.size() != SOLVED_HEADER + (size_t)count * sizeof(SolvedSlot)) {
+		file.close();
+		return false;
+	}
+	slots = (const SolvedSlot*)(file.data() + SOLVED_HEADER);
+	mask = count - 1;
+	return true;
+}
+
+bool SolvedDatabase::probe(const Board& board, SolvedEntry& entry) const {
+	if (!slots) return false;
+	int symmetry;
+	uint32_t key = SolvedKey(CanonicalBoard<4>(board, symmetry));
+	// The table is at most half full, so a probe rarely looks past its home slot.
+	for (uint32_t slot = HomeSlot(key, mask); slots[slot].key; slot = (slot + 1) & mask) {
+		if (slots[slot].key != key) continue;
+		entry.score = slots[slot].score;
+		entry.move = slots[slot].move == NO_MOVE ? NO_MOVE : InverseSquare<4>(slots[slot].move, symmetry);
+		return true;
+	}
+	return false;
+}
+
+using SolvedMap = std::unordered_map<uint32_t, SolvedEntry>;
+
+// Plain negamax over every line of the game, each canonical position solved once.
+static int SolveReachable(const Board& board, SolvedMap& solved) {
+	int symmetry;
+	uint32_t key = SolvedKey(CanonicalBoard<4>(board, symmetry));
+	auto known = solved.find(key);
+	if (known != solved.end()) return known->second.score;
+	SolvedEntry entry;
+	entry.score = -SquareCount<4>() - 1;
+	uint64_t moves = LegalMoves<4>(board);
+	if (!moves) {
+		Board passed = Pass(board);
+		entry.score = LegalMoves<4>(passed) ? -SolveReachable(passed, solved) : PopCount(board.player) - PopCount(board.opponent);
+	}
+	for (; moves; moves &= moves - 1) {
+		uint64_t move = moves & (0 - moves);
+		int score = -SolveReachable(Play<4>(board, move), solved);
+		if (score > entry.score) {
+			entry.score = score;
+			entry.move = TransformSquare<4>((uint8_t)LowestSquare(move), symmetry);
+		}
+	}
+	solved[key] = entry;
+	return entry.score;
+}
+
+int RunSolver(int argc, char** args) {
+	std::string path = SOLVED_FILE;
+	for (int i = 2; i < argc; i++) {
+		std::string option = args[i];
+		if (option == "--out" && i + 1 < argc) path = args[++i];
+		else {
+			std::cerr << "Usage: " << args[0] << " solve [--out <file>]" << std::endl;
+			return 2;
+		}
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	SolvedMap solved;
+	// Either colour may move first, which from the side to move is the start or its mirror image,
+	// and the canonical images of both are the same.
+	int score = SolveReachable(StartingBoard(4), solved);
+
+	uint32_t count = 1;
+	while (count < 2 * solved.size()) count *= 2;
+	std::vector<SolvedSlot> slots(count, SolvedSlot{ 0, 0, NO_MOVE, 0 });
+	for (const auto& position : solved) {
+		uint32_t slot = HomeSlot(position.first, count - 1);
+		while (slots[slot].key) slot = (slot + 1) & (count - 1);
+		slots[slot] = SolvedSlot{ position.first, (int8_t)position.second.score, position.second.move, 0 };
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::ofstream out(path, std::ios::binary);
+	uint32_t header[2] = { SOLVED_VERSION, count };
+	out.write(SOLVED_MAGIC, sizeof(SOLVED_MAGIC));
+	out.write((const char*)header, sizeof(header));
+	out.write((const char*)slots.data(), slots.size() * sizeof(SolvedSlot));
+	if (!out) {
+		std::cerr << "Could not write " << path << "." << std::endl;
+		return 1;
+	}
+	std::cout << "Solved " << solved.size() << " positions in " << seconds << "s, the first player scores " << score
+		<< " with perfect play. Wrote " << count << " slots to " << path << "." << std::endl;
+	return 0;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+#include "bitboard.h"
+#include "mapped.h"
+#include "symmetry.h"
+#include "transposition.h"
+
+// The 4x4 game solved for every position reachable from the start, written once by
+// `othello solve` and mapped into memory by the game, so the minimax player looks its moves up
+// instead of searching them.
+//
+// A 4x4 board fits in 32 bits, so the file is an open addressing hash table keyed by the whole
+// canonical board, which makes every probe exact, and holding one of the eight images of each
+// position keeps the table small enough to stay in the cache.
+constexpr const char* SOLVED_FILE = "othello4x4.solved";
+
+struct SolvedEntry {
+	int score = 0; // Final disc difference for the side to move with perfect play by both sides.
+	uint8_t move = NO_MOVE; // Square of a best move, NO_MOVE if the side to move has to pass.
+};
+
+// One slot of the table as stored in the file, key 0 marks an empty slot. No position has
+// key 0, the centre squares are never empty.
+struct SolvedSlot {
+	uint32_t key;
+	int8_t score;
+	uint8_t move; // In the canonical board's squares.
+	uint16_t unused;
+};
+
+inline uint32_t SolvedKey(const Board& canonical) {
+	return (uint32_t)canonical.player | (uint32_t)canonical.opponent << 16;
+}
+
+class SolvedDatabase {
+public:
+	// Maps the file at path, false if it is missing or not a solved 4x4 database.
+	bool open(const std::string& path);
+	inline bool isOpen() const { return slots != nullptr; }
+
+	// Looks board up, false if it cannot arise in a game from the starting position.
+	bool probe(const Board& board, SolvedEntry& entry) const;
+
+private:
+	MappedFile file;
+	const SolvedSlot* slots = nullptr;
+	uint32_t mask = 0; // Slot count minus one, the count is a power of two.
+};
+
+// Loaded by the game for 4x4 boards, probed by MiniMaxDecision before it searches.
+extern SolvedDatabase SolvedGame;
+
+// Solves every reachable 4x4 position and writes the database, run as: othello solve [--out <file>]
+int RunSolver(int argc, char** args);
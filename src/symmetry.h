@@ -0,0 +1,155 @@
+#pragma once
+#include <cstdint>
+
+#include "bitboard.h"
+
+// The eight symmetries of the square board. Bit 2 of a symmetry transposes the board, swapping x
+// and y, then bit 0 mirrors x and bit 1 mirrors y. Symmetry 0 leaves the board as it is.
+constexpr int SYMMETRIES = 8;
+
+// Every square with the given x.
+template<int N>
+constexpr uint64_t ColumnMask(int x) {
+	return ((1ULL << N) - 1) << (x * N);
+}
+
+// The squares (x, x + k), the k-th diagonal above the main one.
+template<int N>
+constexpr uint64_t DiagonalMask(int k, int x = 0) {
+	return x + k >= N ? 0 : (1ULL << (x * N + x + k)) | DiagonalMask<N>(k, x + 1);
+}
+
+// Swaps the bits in mask with the bits delta squares above them.
+inline uint64_t DeltaSwap(uint64_t bits, uint64_t mask, int delta) {
+	uint64_t swapped = ((bits >> delta) ^ bits) & mask;
+	return bits ^ swapped ^ (swapped << delta);
+}
+
+template<int N>
+inline uint64_t MirrorX(uint64_t bits) {
+	static constexpr uint64_t columns[4] = { ColumnMask<N>(0), ColumnMask<N>(1), ColumnMask<N>(2), ColumnMask<N>(3) };
+	for (int x = 0; x < N / 2; x++) bits = DeltaSwap(bits, columns[x], (N - 1 - 2 * x) * N);
+	return bits;
+}
+
+template<int N>
+inline uint64_t MirrorY(uint64_t bits) {
+	static constexpr uint64_t rows[4] = { RowMask<N>(0), RowMask<N>(1), RowMask<N>(2), RowMask<N>(3) };
+	for (int y = 0; y < N / 2; y++) bits = DeltaSwap(bits, rows[y], N - 1 - 2 * y);
+	return bits;
+}
+
+template<int N>
+inline uint64_t Transpose(uint64_t bits) {
+	static constexpr uint64_t diagonals[8] = { 0, DiagonalMask<N>(1), DiagonalMask<N>(2), DiagonalMask<N>(3), DiagonalMask<N>(4), DiagonalMask<N>(5), DiagonalMask<N>(6), DiagonalMask<N>(7) };
+	for (int k = 1; k < N; k++) bits = DeltaSwap(bits, diagonals[k], k * (N - 1));
+	return bits;
+}
+
+// On 8x8 a column is a byte, so the same three transforms take a byte swap and three delta swaps each.
+template<>
+inline uint64_t MirrorX<8>(uint64_t bits) {
+#ifdef _MSC_VER
+	return _byteswap_uint64(bits);
+#else
+	return __builtin_bswap64(bits);
+#endif
+}
+
+template<>
+inline uint64_t MirrorY<8>(uint64_t bits) {
+	bits = ((bits >> 1) & 0x5555555555555555ULL) | ((bits & 0x5555555555555555ULL) << 1);
+	bits = ((bits >> 2) & 0x3333333333333333ULL) | ((bits & 0x3333333333333333ULL) << 2);
+	return ((bits >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((bits & 0x0F0F0F0F0F0F0F0FULL) << 4);
+}
+
+template<>
+inline uint64_t Transpose<8>(uint64_t bits) {
+	bits = DeltaSwap(bits, 0x00000000F0F0F0F0ULL, 28);
+	bits = DeltaSwap(bits, 0x0000CCCC0000CCCCULL, 14);
+	return DeltaSwap(bits, 0x00AA00AA00AA00AAULL, 7);
+}
+
+template<int N>
+inline uint64_t TransformBits(uint64_t bits, int symmetry) {
+	if (symmetry & 4) bits = Transpose<N>(bits);
+	if (symmetry & 1) bits = MirrorX<N>(bits);
+	if (symmetry & 2) bits = MirrorY<N>(bits);
+	return bits;
+}
+
+template<int N>
+inline Board TransformBoard(const Board& board, int symmetry) {
+	return Board(TransformBits<N>(board.player, symmetry), TransformBits<N>(board.opponent, symmetry));
+}
+
+template<int N>
+inline uint8_t TransformSquare(uint8_t square, int symmetry) {
+	int x = square / N, y = square % N;
+	if (symmetry & 4) {
+		int swap = x;
+		x = y;
+		y = swap;
+	}
+	if (symmetry & 1) x = N - 1 - x;
+	if (symmetry & 2) y = N - 1 - y;
+	return (uint8_t)(x * N + y);
+}
+
+// Undoes TransformSquare: the square of the original board that symmetry moved to square.
+template<int N>
+inline uint8_t InverseSquare(uint8_t square, int symmetry) {
+	int x = square / N, y = square % N;
+	if (symmetry & 1) x = N - 1 - x;
+	if (symmetry & 2) y = N - 1 - y;
+	return (uint8_t)((symmetry & 4) ? y * N + x : x * N + y);
+}
+
+// The smallest of the eight images of board, comparing the player's discs first. symmetry gets
+// the one that maps board onto it.
+template<int N>
+inline Board CanonicalBoard(const Board& board, int& symmetry) {
+	Board best = board;
+	symmetry = 0;
+	Board bases[2] = { board, Board(Transpose<N>(board.player), Transpose<N>(board.opponent)) };
+	for (int transposed = 0; transposed < 2; transposed++) {
+		const Board& base = bases[transposed];
+		Board mirroredX(MirrorX<N>(base.player), MirrorX<N>(base.opponent));
+		Board images[4] = { base, mirroredX, Board(MirrorY<N>(base.player), MirrorY<N>(base.opponent)), Board(MirrorY<N>(mirroredX.player), MirrorY<N>(mirroredX.opponent)) };
+		for (int mirrors = 0; mirrors < 4; mirrors++) {
+			const Board& image = images[mirrors];
+			if (image.player < best.player || (image.player == best.player && image.opponent < best.opponent)) {
+				best = image;
+				symmetry = transposed * 4 + mirrors;
+			}
+		}
+	}
+	return best;
+}
+
+// splitmix64's finalizer.
+inline uint64_t MixBits(uint64_t bits) {
+	bits ^= bits >> 30;
+	bits *= 0xBF58476D1CE4E5B9ULL;
+	bits ^= bits >> 27;
+	bits *= 0x94D049BB133111EBULL;
+	return bits ^ (bits >> 31);
+}
+
+// The same for every image of board. Scores and moves are relative to the side to move, so
+// the colour to move is left out and the two colours share entries too.
+template<int N>
+inline uint64_t CanonicalHash(const Board& board, int& symmetry) {
+	Board canonical = CanonicalBoard<N>(board, symmetry);
+	return MixBits(MixBits(canonical.player) ^ canonical.opponent);
+}
+
+// The symmetries that map board onto itself, as a bit set over symmetries 1 to 7.
+template<int N>
+inline uint32_t SelfSymmetries(const Board& board) {
+	uint32_t symmetries = 0;
+	for (int symmetry = 1; symmetry < SYMMETRIES; symmetry++) {
+		if (TransformBoard<N>(board, symmetry) == board) symmetries |= 1u << symmetry;
+	}
+	return symmetries;
+}
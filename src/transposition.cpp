@@ -0,0 +1,79 @@
+#include "transposition.h"
+
+#include <new>
+
+// Data word layout: score (16 bits, two's complement) | depth (8) | bound (8) | move (8) | generation (8).
+static inline uint64_t Pack(int score, int depth, Bound bound, uint8_t move, uint8_t generation) {
+	return (uint64_t)(uint16_t)(int16_t)score | ((uint64_t)(uint8_t)depth << 16) | ((uint64_t)bound << 24) | ((uint64_t)move << 32) | ((uint64_t)generation << 40);
+}
+
+static inline uint8_t GenerationOf(uint64_t data) {
+	return (uint8_t)((data >> 40) & 0xFF);
+}
+
+static inline TTEntry Unpack(uint64_t data) {
+	TTEntry entry;
+	entry.score = (int16_t)(uint16_t)(data & 0xFFFF);
+	entry.depth = (int)((data >> 16) & 0xFF);
+	entry.bound = (Bound)((data >> 24) & 0xFF);
+	entry.move = (uint8_t)((data >> 32) & 0xFF);
+	return entry;
+}
+
+TranspositionTable::TranspositionTable(size_t megabytes) {
+	resize(megabytes);
+}
+
+void TranspositionTable::resize(size_t megabytes) {
+	size_t count = 1;
+	while (count * 2 * sizeof(Bucket) <= megabytes * 1024 * 1024) count *= 2;
+	memory.reset(new char[count * sizeof(Bucket) + alignof(Bucket)]);
+	uintptr_t address = (uintptr_t)memory.get();
+	buckets = (Bucket*)((address + alignof(Bucket) - 1) & ~(uintptr_t)(alignof(Bucket) - 1));
+	bucketCount = count;
+	for (size_t i = 0; i < bucketCount; i++) new (&buckets[i]) Bucket();
+}
+
+void TranspositionTable::clear() {
+	for (size_t i = 0; i < bucketCount; i++) {
+		for (Slot& slot : buckets[i].slots) {
+			slot.check.store(0, std::memory_order_relaxed);
+			slot.data.store(0, std::memory_order_relaxed);
+		}
+	}
+}
+
+bool TranspositionTable::probe(uint64_t key, TTEntry& entry) const {
+	Bucket& bucket = bucketFor(key);
+	for (Slot& slot : bucket.slots) {
+		uint64_t data = slot.data.load(std::memory_order_relaxed);
+		if ((slot.check.load(std::memory_order_relaxed) ^ data) == key && data) {
+			entry = Unpack(data);
+			return true;
+		}
+	}
+	return false;
+}
+
+void TranspositionTable::store(uint64_t key, int score, int depth, Bound bound, uint8_t move) {
+	Bucket& bucket = bucketFor(key);
+	Slot* replace = &bucket.slots[0];
+	int replaceValue = 512;
+	for (Slot& slot : bucket.slots) {
+		uint64_t data = slot.data.load(std::memory_order_relaxed);
+		if ((slot.check.load(std::memory_order_relaxed) ^ data) == key || !data) { // Same position or an empty slot.
+			replace = &slot;
+			if (data && move == NO_MOVE) move = Unpack(data).move; // Keep the old best move around for ordering.
+			break;
+		}
+		// Otherwise evict the shallowest result, left over from an earlier decision if there is one.
+		int slotValue = Unpack(data).depth + (GenerationOf(data) == generation ? 256 : 0);
+		if (slotValue < replaceValue) {
+			replace = &slot;
+			replaceValue = slotValue;
+		}
+	}
+	uint64_t data = Pack(score, depth, bound, move, generation);
+	replace->check.store(key ^ data, std::memory_order_relaxed);
+	replace->data.store(data, std::memory_order_relaxed);
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+enum class Bound : uint8_t { NONE, UPPER, LOWER, EXACT };
+
+constexpr uint8_t NO_MOVE = 0xFF;
+
+struct TTEntry {
+	int score = 0;
+	int depth = 0;
+	Bound bound = Bound::NONE;
+	uint8_t move = NO_MOVE;
+};
+
+// Hash table of search results shared by every search thread without locks.
+// Each slot stores key ^ data next to data; a probe only accepts a slot whose two words still
+// XOR back to the probed key, so a slot torn by two threads writing at once reads as a miss.
+class TranspositionTable {
+public:
+	static constexpr size_t BUCKET_ENTRIES = 4;
+
+	TranspositionTable(size_t megabytes);
+
+	// Frees the old table, sizes the new one to the largest power of two buckets fitting megabytes.
+	void resize(size_t megabytes);
+	void clear();
+	// Starts a new decision. Entries of earlier ones can still be probed, but are the first to be replaced.
+	inline void newGeneration() { generation++; }
+
+	bool probe(uint64_t key, TTEntry& entry) const;
+	void store(uint64_t key, int score, int depth, Bound bound, uint8_t move);
+
+	inline size_t getBucketCount() const { return bucketCount; }
+
+private:
+	struct Slot {
+		std::atomic<uint64_t> check{ 0 };
+		std::atomic<uint64_t> data{ 0 };
+	};
+	// One bucket per cache line, so a probe touches a single line.
+	struct alignas(64) Bucket {
+		Slot slots[BUCKET_ENTRIES];
+	};
+
+	std::unique_ptr<char[]> memory;
+	Bucket* buckets = nullptr;
+	size_t bucketCount = 0;
+	uint8_t generation = 0;
+
+	inline Bucket& bucketFor(uint64_t key) const { return buckets[key & (bucketCount - 1)]; }
+};
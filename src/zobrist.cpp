@@ -0,0 +1,20 @@
+#include "zobrist.h"
+
+// SplitMix64 with a fixed seed, so keys (and anything stored by them) are the same on every run.
+static uint64_t NextKey(uint64_t& state) {
+	uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+ZobristKeys::ZobristKeys() {
+	uint64_t state = 0x4F7468656C6C6F00ULL;
+	for (int color = 0; color < 2; color++) {
+		for (int square = 0; square < 64; square++) squares[color][square] = NextKey(state);
+	}
+	for (int square = 0; square < 64; square++) flips[square] = squares[0][square] ^ squares[1][square];
+	side = NextKey(state);
+}
+
+const ZobristKeys Zobrist;
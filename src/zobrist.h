@@ -0,0 +1,31 @@
+#pragma once
+#include <cstdint>
+
+#include "bitboard.h"
+
+// Random keys for every (colour, square) pair and for the side to move.
+// Colour 0 is the first player (light) and colour 1 the second (dark), on every board size.
+struct ZobristKeys {
+	uint64_t squares[2][64];
+	uint64_t flips[64]; // squares[0][i] ^ squares[1][i], what turning the disc on i over changes.
+	uint64_t side;
+
+	ZobristKeys();
+};
+
+extern const ZobristKeys Zobrist;
+
+// Hash of board from scratch, side is the colour of board.player.
+inline uint64_t ZobristHash(const Board& board, int side) {
+	uint64_t hash = side ? Zobrist.side : 0;
+	for (uint64_t bits = board.player; bits; bits &= bits - 1) hash ^= Zobrist.squares[side][LowestSquare(bits)];
+	for (uint64_t bits = board.opponent; bits; bits &= bits - 1) hash ^= Zobrist.squares[side ^ 1][LowestSquare(bits)];
+	return hash;
+}
+
+// Change of the hash when side places move and turns the discs in flips over, the side to move toggles too.
+inline uint64_t ZobristMoveDelta(uint64_t move, uint64_t flips, int side) {
+	uint64_t delta = Zobrist.side ^ Zobrist.squares[side][LowestSquare(move)];
+	for (; flips; flips &= flips - 1) delta ^= Zobrist.flips[LowestSquare(flips)];
+	return delta;
+}